@@ -48,8 +48,7 @@ Detector::Detector(std::string name,
  * model is added.
  */
 Detector::Detector(std::string name, ROOT::Math::XYZPoint position, const ROOT::Math::Rotation3D& orientation)
-    : name_(std::move(name)), position_(std::move(position)), orientation_(orientation), electric_field_sizes_{{0, 0, 0}},
-      electric_field_(nullptr) {}
+    : name_(std::move(name)), position_(std::move(position)), orientation_(orientation) {}
 void Detector::set_model(std::shared_ptr<DetectorModel> model) {
     model_ = std::move(model);
     build_transform();
@@ -132,8 +131,7 @@ Pixel Detector::getPixel(unsigned int x, unsigned int y) {
  * stage). Outside of the sensor the electric field is strictly zero by definition.
  */
 bool Detector::hasElectricField() const {
-    return electric_field_function_ ||
-           (electric_field_sizes_[0] != 0 && electric_field_sizes_[1] != 0 && electric_field_sizes_[2] != 0);
+    return electric_field_function_ || electric_field_grid_ != nullptr;
 }
 
 /**
@@ -152,12 +150,13 @@ ROOT::Math::XYZVector Detector::getElectricField(const ROOT::Math::XYZPoint& pos
 
     // Compute corresponding pixel coordinates
     // WARNING This relies on the origin of the local coordinate system
-    auto pixel_x = static_cast<int>(std::round(x / model_->getPixelSize().x()));
-    auto pixel_y = static_cast<int>(std::round(y / model_->getPixelSize().y()));
+    auto pixel_size = model_->getPixelSize();
+    auto pixel_x = static_cast<int>(std::round(x / pixel_size.x()));
+    auto pixel_y = static_cast<int>(std::round(y / pixel_size.y()));
 
     // Convert to the pixel frame
-    x -= pixel_x * model_->getPixelSize().x();
-    y -= pixel_y * model_->getPixelSize().y();
+    x -= pixel_x * pixel_size.x();
+    y -= pixel_y * pixel_size.y();
 
     // Do flipping if necessary
     if((pixel_x % 2) == 1) {
@@ -170,28 +169,8 @@ ROOT::Math::XYZVector Detector::getElectricField(const ROOT::Math::XYZPoint& pos
     // Compute using the grid or a function depending on the setting
     ROOT::Math::XYZVector ret_val;
     if(electric_field_type_ == ElectricFieldType::GRID) {
-        // Compute indices
-        auto x_ind = static_cast<int>(std::floor(static_cast<double>(electric_field_sizes_[0]) *
-                                                 (x + model_->getPixelSize().x() / 2.0) / model_->getPixelSize().x()));
-        auto y_ind = static_cast<int>(std::floor(static_cast<double>(electric_field_sizes_[1]) *
-                                                 (y + model_->getPixelSize().y() / 2.0) / model_->getPixelSize().y()));
-        auto z_ind = static_cast<int>(
-            std::floor(static_cast<double>(electric_field_sizes_[2]) * (z - electric_field_thickness_domain_.first) /
-                       (electric_field_thickness_domain_.second - electric_field_thickness_domain_.first)));
-
-        // Check for indices within the sensor
-        if(x_ind < 0 || x_ind >= static_cast<int>(electric_field_sizes_[0]) || y_ind < 0 ||
-           y_ind >= static_cast<int>(electric_field_sizes_[1]) || z_ind < 0 ||
-           z_ind >= static_cast<int>(electric_field_sizes_[2])) {
-            return ROOT::Math::XYZVector(0, 0, 0);
-        }
-
-        // Compute total index
-        size_t tot_ind = static_cast<size_t>(x_ind) * electric_field_sizes_[1] * electric_field_sizes_[2] * 3 +
-                         static_cast<size_t>(y_ind) * electric_field_sizes_[2] * 3 + static_cast<size_t>(z_ind) * 3;
-
-        ret_val = ROOT::Math::XYZVector(
-            (*electric_field_)[tot_ind], (*electric_field_)[tot_ind + 1], (*electric_field_)[tot_ind + 2]);
+        // Look up the field in the grid
+        ret_val = electric_field_grid_->get(ROOT::Math::XYZPoint(x, y, z));
     } else {
         // Check if inside the thickness domain
         if(z < electric_field_thickness_domain_.first || electric_field_thickness_domain_.second < z) {
@@ -231,24 +210,38 @@ ElectricFieldType Detector::getElectricFieldType() const {
  * - x*Y_SIZE*Z_SIZE*3+y*Z_SIZE*3+z*3: the x-component of the electric field
  * - x*Y_SIZE*Z_SIZE*3+y*Z_SIZE*3+z*3+1: the y-component of the electric field
  * - x*Y_SIZE*Z_SIZE*3+y*Z_SIZE*3+z*3+2: the z-component of the electric field
+ *
+ * The array is converted into an \ref ElectricFieldGrid, which stores the field in tiles for faster lookup and optionally
+ * interpolates the field trilinearly between the grid points.
  */
 void Detector::setElectricFieldGrid(std::shared_ptr<std::vector<double>> field,
                                     std::array<size_t, 3> sizes,
-                                    std::pair<double, double> thickness_domain) {
-    if(sizes[0] * sizes[1] * sizes[2] * 3 != field->size()) {
-        throw std::invalid_argument("electric field does not match the given sizes");
+                                    std::pair<double, double> thickness_domain,
+                                    bool interpolate) {
+    if(thickness_domain.first >= thickness_domain.second) {
+        throw std::invalid_argument("end of thickness domain is before begin");
     }
+
+    // Convert the flat array into the grid used for the lookup
+    setElectricFieldGrid(
+        std::make_shared<ElectricFieldGrid>(*field, sizes, model_->getPixelSize(), thickness_domain, interpolate));
+}
+
+/**
+ * @throws std::invalid_argument If the grid does not cover the pixel of the detector or is outside the sensor
+ */
+void Detector::setElectricFieldGrid(std::shared_ptr<ElectricFieldGrid> grid) {
+    auto thickness_domain = grid->getThicknessDomain();
     if(thickness_domain.first + 1e-9 < model_->getSensorCenter().z() - model_->getSensorSize().z() / 2.0 ||
        model_->getSensorCenter().z() + model_->getSensorSize().z() / 2.0 < thickness_domain.second - 1e-9) {
         throw std::invalid_argument("thickness domain is outside sensor dimensions");
     }
-    if(thickness_domain.first >= thickness_domain.second) {
-        throw std::invalid_argument("end of thickness domain is before begin");
+    if((grid->getPixelSize() - model_->getPixelSize()).Mag2() > 1e-18) {
+        throw std::invalid_argument("electric field grid does not match the pixel size");
     }
 
-    electric_field_ = std::move(field);
-    electric_field_sizes_ = sizes;
-    electric_field_thickness_domain_ = std::move(thickness_domain);
+    electric_field_grid_ = std::move(grid);
+    electric_field_thickness_domain_ = thickness_domain;
     electric_field_type_ = ElectricFieldType::GRID;
 }
 
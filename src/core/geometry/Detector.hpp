@@ -26,6 +26,7 @@
 
 #include "Detector.hpp"
 #include "DetectorModel.hpp"
+#include "ElectricFieldGrid.hpp"
 
 #include "objects/Pixel.hpp"
 
@@ -136,10 +137,17 @@ namespace allpix {
          * @param field Flat array of the field vectors (see detailed description)
          * @param sizes The dimensions of the flat electric field array
          * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param interpolate True if the field should be interpolated trilinearly between the grid points
          */
         void setElectricFieldGrid(std::shared_ptr<std::vector<double>> field,
                                   std::array<size_t, 3> sizes,
-                                  std::pair<double, double> thickness_domain);
+                                  std::pair<double, double> thickness_domain,
+                                  bool interpolate = false);
+        /**
+         * @brief Set the electric field in a single pixel in the detector to an existing grid
+         * @param grid Grid of the field, possibly shared with other detectors with the same pixel geometry
+         */
+        void setElectricFieldGrid(std::shared_ptr<ElectricFieldGrid> grid);
         /**
          * @brief Set the electric field in a single pixel using a function
          * @param function Function used to retrieve the electric field
@@ -198,8 +206,7 @@ namespace allpix {
         // Transform matrix from global to local coordinates
         ROOT::Math::Transform3D transform_;
 
-        std::array<size_t, 3> electric_field_sizes_;
-        std::shared_ptr<std::vector<double>> electric_field_;
+        std::shared_ptr<ElectricFieldGrid> electric_field_grid_;
         std::pair<double, double> electric_field_thickness_domain_;
         ElectricFieldType electric_field_type_{ElectricFieldType::NONE};
         ElectricFieldFunction electric_field_function_;
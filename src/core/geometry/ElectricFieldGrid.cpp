@@ -0,0 +1,169 @@
+/**
+ * @file
+ * @brief Implementation of the electric field grid
+ *
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include <cmath>
+#include <stdexcept>
+
+#include "ElectricFieldGrid.hpp"
+
+using namespace allpix;
+
+constexpr size_t ElectricFieldGrid::tile_size;
+
+/**
+ * @throws std::invalid_argument If the electric field sizes are incorrect
+ *
+ * The flat array is converted into a new tiled array, which is owned by the grid and shared with all grids built from it.
+ */
+ElectricFieldGrid::ElectricFieldGrid(const std::vector<double>& field,
+                                     std::array<size_t, 3> sizes,
+                                     ROOT::Math::XYVector pixel_size,
+                                     std::pair<double, double> thickness_domain,
+                                     bool interpolate)
+    : sizes_(sizes), tiles_(get_tiles(sizes)), interpolate_(interpolate) {
+    auto tiled_field = std::make_shared<const std::vector<double>>(tile(field, sizes));
+    field_ = std::shared_ptr<const double>(tiled_field, tiled_field->data());
+
+    set_geometry(pixel_size, thickness_domain);
+}
+
+/**
+ * The field vectors are not copied, the grid reads them directly from the given storage.
+ */
+ElectricFieldGrid::ElectricFieldGrid(std::shared_ptr<const double> tiled_field,
+                                     std::array<size_t, 3> sizes,
+                                     ROOT::Math::XYVector pixel_size,
+                                     std::pair<double, double> thickness_domain,
+                                     bool interpolate)
+    : field_(std::move(tiled_field)), sizes_(sizes), tiles_(get_tiles(sizes)), interpolate_(interpolate) {
+    set_geometry(pixel_size, thickness_domain);
+}
+
+/**
+ * Only the conversion from positions to cell coordinates is computed again, the field vectors are not copied.
+ */
+ElectricFieldGrid::ElectricFieldGrid(const ElectricFieldGrid& grid,
+                                     ROOT::Math::XYVector pixel_size,
+                                     std::pair<double, double> thickness_domain,
+                                     bool interpolate)
+    : field_(grid.field_), sizes_(grid.sizes_), tiles_(grid.tiles_), interpolate_(interpolate) {
+    set_geometry(pixel_size, thickness_domain);
+}
+
+std::array<size_t, 3> ElectricFieldGrid::get_tiles(std::array<size_t, 3> sizes) {
+    std::array<size_t, 3> tiles{};
+    for(size_t i = 0; i < 3; ++i) {
+        tiles[i] = (sizes[i] + tile_size - 1) / tile_size;
+    }
+    return tiles;
+}
+
+size_t ElectricFieldGrid::getTiledLength(std::array<size_t, 3> sizes) {
+    auto tiles = get_tiles(sizes);
+    return tiles[0] * tiles[1] * tiles[2] * tile_size * tile_size * tile_size * 3;
+}
+
+/**
+ * The grid is padded to a multiple of the tile size in every dimension. The padded cells are never accessed.
+ */
+std::vector<double> ElectricFieldGrid::tile(const std::vector<double>& field, std::array<size_t, 3> sizes) {
+    if(sizes[0] * sizes[1] * sizes[2] * 3 != field.size()) {
+        throw std::invalid_argument("electric field does not match the given sizes");
+    }
+
+    // Copy the field from the flat array into the tiles
+    auto tiles = get_tiles(sizes);
+    std::vector<double> tiled_field(getTiledLength(sizes));
+    for(size_t x = 0; x < sizes[0]; ++x) {
+        for(size_t y = 0; y < sizes[1]; ++y) {
+            for(size_t z = 0; z < sizes[2]; ++z) {
+                auto flat_index = ((x * sizes[1] + y) * sizes[2] + z) * 3;
+                auto index = tiled_index(tiles, x, y, z);
+                for(size_t i = 0; i < 3; ++i) {
+                    tiled_field[index + i] = field[flat_index + i];
+                }
+            }
+        }
+    }
+    return tiled_field;
+}
+
+void ElectricFieldGrid::set_geometry(ROOT::Math::XYVector pixel_size, std::pair<double, double> thickness_domain) {
+    pixel_size_ = pixel_size;
+    thickness_domain_ = thickness_domain;
+    inverse_cell_size_[0] = static_cast<double>(sizes_[0]) / pixel_size.x();
+    inverse_cell_size_[1] = static_cast<double>(sizes_[1]) / pixel_size.y();
+    inverse_cell_size_[2] = static_cast<double>(sizes_[2]) / (thickness_domain.second - thickness_domain.first);
+    offset_[0] = static_cast<double>(sizes_[0]) / 2.0;
+    offset_[1] = static_cast<double>(sizes_[1]) / 2.0;
+    offset_[2] = -thickness_domain.first * inverse_cell_size_[2];
+}
+
+/**
+ * The field is zero outside of the grid. For trilinear interpolation the field is interpolated between the centers of the
+ * eight closest cells. Near the boundaries of the grid, the field of the outermost cells is used instead of extrapolating.
+ */
+ROOT::Math::XYZVector ElectricFieldGrid::get(const ROOT::Math::XYZPoint& pos) const {
+    // Compute the coordinates in units of cells
+    std::array<double, 3> coordinates{{pos.x() * inverse_cell_size_[0] + offset_[0],
+                                       pos.y() * inverse_cell_size_[1] + offset_[1],
+                                       pos.z() * inverse_cell_size_[2] + offset_[2]}};
+
+    const double* tiled_field = field_.get();
+
+    // Check for positions within the grid
+    for(size_t i = 0; i < 3; ++i) {
+        if(!(coordinates[i] >= 0) || coordinates[i] >= static_cast<double>(sizes_[i])) {
+            return ROOT::Math::XYZVector(0, 0, 0);
+        }
+    }
+
+    if(!interpolate_) {
+        // Use the field of the cell containing the position
+        auto index = tiled_index(tiles_,
+                                 static_cast<size_t>(coordinates[0]),
+                                 static_cast<size_t>(coordinates[1]),
+                                 static_cast<size_t>(coordinates[2]));
+        return ROOT::Math::XYZVector(tiled_field[index], tiled_field[index + 1], tiled_field[index + 2]);
+    }
+
+    // Find the lower and upper cells and the weights of the upper cells
+    std::array<size_t, 3> lower{}, upper{};
+    std::array<double, 3> weight{};
+    for(size_t i = 0; i < 3; ++i) {
+        auto center_coordinate = coordinates[i] - 0.5;
+        auto lower_coordinate = std::floor(center_coordinate);
+        weight[i] = center_coordinate - lower_coordinate;
+        if(lower_coordinate < 0) {
+            lower[i] = 0;
+            upper[i] = 0;
+        } else {
+            lower[i] = static_cast<size_t>(lower_coordinate);
+            upper[i] = (lower[i] + 1 < sizes_[i] ? lower[i] + 1 : lower[i]);
+        }
+    }
+
+    // Interpolate between the eight neighbouring cells
+    std::array<double, 3> field{};
+    for(size_t corner = 0; corner < 8; ++corner) {
+        auto x = ((corner & 4) != 0u ? upper[0] : lower[0]);
+        auto y = ((corner & 2) != 0u ? upper[1] : lower[1]);
+        auto z = ((corner & 1) != 0u ? upper[2] : lower[2]);
+        auto corner_weight = ((corner & 4) != 0u ? weight[0] : 1 - weight[0]) *
+                             ((corner & 2) != 0u ? weight[1] : 1 - weight[1]) *
+                             ((corner & 1) != 0u ? weight[2] : 1 - weight[2]);
+
+        auto index = tiled_index(tiles_, x, y, z);
+        for(size_t i = 0; i < 3; ++i) {
+            field[i] += corner_weight * tiled_field[index + i];
+        }
+    }
+    return ROOT::Math::XYZVector(field[0], field[1], field[2]);
+}
@@ -0,0 +1,177 @@
+/**
+ * @file
+ * @brief Regular grid holding the electric field of a single pixel
+ *
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_ELECTRIC_FIELD_GRID_H
+#define ALLPIX_ELECTRIC_FIELD_GRID_H
+
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <Math/Point3D.h>
+#include <Math/Vector2D.h>
+#include <Math/Vector3D.h>
+
+namespace allpix {
+
+    /**
+     * @brief Electric field of a single pixel on a regular grid
+     *
+     * The field vectors are stored in cubic tiles of \ref ElectricFieldGrid::tile_size cells in every direction, such that
+     * neighbouring cells in all three directions are mostly located in the same cache lines. The inverse cell sizes are
+     * precomputed, so that a lookup only requires multiplications. The field can either be returned for the nearest cell or
+     * trilinearly interpolated between the centers of the neighbouring cells.
+     *
+     * The grid only holds a view of the tiled field vectors together with the owner of their storage, which is either an
+     * array built by the grid itself or a memory mapping of a binary field file already stored in the tiled layout.
+     */
+    class ElectricFieldGrid {
+    public:
+        /**
+         * @brief Build the grid from a flat array of field vectors
+         * @param field Flat array of the field vectors (see \ref Detector::setElectricFieldGrid for the layout)
+         * @param sizes The dimensions of the flat electric field array
+         * @param pixel_size Size of the pixel in x and y covered by the grid
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param interpolate True if the field should be interpolated trilinearly, false for the nearest cell
+         */
+        ElectricFieldGrid(const std::vector<double>& field,
+                          std::array<size_t, 3> sizes,
+                          ROOT::Math::XYVector pixel_size,
+                          std::pair<double, double> thickness_domain,
+                          bool interpolate = false);
+
+        /**
+         * @brief Build the grid on field vectors already stored in the tiled layout
+         * @param tiled_field Pointer to the tiled field vectors (see \ref ElectricFieldGrid::tile), which keeps their
+         * storage alive for the lifetime of the grid
+         * @param sizes The dimensions of the electric field in cells
+         * @param pixel_size Size of the pixel in x and y covered by the grid
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param interpolate True if the field should be interpolated trilinearly, false for the nearest cell
+         */
+        ElectricFieldGrid(std::shared_ptr<const double> tiled_field,
+                          std::array<size_t, 3> sizes,
+                          ROOT::Math::XYVector pixel_size,
+                          std::pair<double, double> thickness_domain,
+                          bool interpolate = false);
+
+        /**
+         * @brief Build a grid for another pixel geometry sharing the field vectors of an existing grid
+         * @param grid Grid to share the field vectors with
+         * @param pixel_size Size of the pixel in x and y covered by the grid
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         * @param interpolate True if the field should be interpolated trilinearly, false for the nearest cell
+         */
+        ElectricFieldGrid(const ElectricFieldGrid& grid,
+                          ROOT::Math::XYVector pixel_size,
+                          std::pair<double, double> thickness_domain,
+                          bool interpolate = false);
+
+        /**
+         * @brief Get the electric field at a position in the pixel frame
+         * @param pos Position relative to the center of the pixel in x and y and in local coordinates in z
+         * @return Vector of the field at the queried point (zero outside of the grid)
+         */
+        ROOT::Math::XYZVector get(const ROOT::Math::XYZPoint& pos) const;
+
+        /**
+         * @brief Get the dimensions of the grid
+         * @return Number of cells in every dimension
+         */
+        std::array<size_t, 3> getSizes() const { return sizes_; }
+
+        /**
+         * @brief Return if the field is interpolated
+         * @return True if trilinear interpolation is used, false if the nearest cell is used
+         */
+        bool isInterpolated() const { return interpolate_; }
+
+        /**
+         * @brief Get the size of the pixel covered by the grid
+         * @return Size of the pixel in x and y
+         */
+        ROOT::Math::XYVector getPixelSize() const { return pixel_size_; }
+
+        /**
+         * @brief Get the domain in the thickness direction covered by the grid
+         * @return Domain in local coordinates in the thickness direction
+         */
+        std::pair<double, double> getThicknessDomain() const { return thickness_domain_; }
+
+        /**
+         * @brief Number of cells in every direction of a tile
+         */
+        static constexpr size_t tile_size = 4;
+
+        /**
+         * @brief Get the number of values in the tiled layout of a field
+         * @param sizes The dimensions of the electric field in cells
+         * @return Number of values including the padding of the tiles
+         */
+        static size_t getTiledLength(std::array<size_t, 3> sizes);
+
+        /**
+         * @brief Convert a flat array of field vectors into the tiled layout
+         * @param field Flat array of the field vectors (see \ref Detector::setElectricFieldGrid for the layout)
+         * @param sizes The dimensions of the flat electric field array
+         * @return Field vectors in the tiled layout, with zeros in the padded cells
+         * @throws std::invalid_argument If the electric field sizes are incorrect
+         */
+        static std::vector<double> tile(const std::vector<double>& field, std::array<size_t, 3> sizes);
+
+    private:
+        /**
+         * @brief Precompute the conversion from positions to cell coordinates for a pixel geometry
+         * @param pixel_size Size of the pixel in x and y covered by the grid
+         * @param thickness_domain Domain in local coordinates in the thickness direction where the field holds
+         */
+        void set_geometry(ROOT::Math::XYVector pixel_size, std::pair<double, double> thickness_domain);
+
+        /**
+         * @brief Get the number of tiles in every dimension
+         * @param sizes The dimensions of the electric field in cells
+         * @return Number of tiles covering the cells in every dimension
+         */
+        static std::array<size_t, 3> get_tiles(std::array<size_t, 3> sizes);
+
+        /**
+         * @brief Get the position of the field vector of a cell in the tiled storage
+         * @param tiles Number of tiles in every dimension
+         * @param x Index of the cell in x
+         * @param y Index of the cell in y
+         * @param z Index of the cell in z
+         * @return Index of the x-component of the field vector, followed by the y- and z-component
+         */
+        static size_t tiled_index(const std::array<size_t, 3>& tiles, size_t x, size_t y, size_t z) {
+            size_t tile = ((x / tile_size) * tiles[1] + y / tile_size) * tiles[2] + z / tile_size;
+            size_t cell = ((x % tile_size) * tile_size + y % tile_size) * tile_size + z % tile_size;
+            return (tile * tile_size * tile_size * tile_size + cell) * 3;
+        }
+
+        // View of the tiled field vectors owning their storage, shared between the grids of all pixel geometries using the
+        // same field
+        std::shared_ptr<const double> field_;
+        std::array<size_t, 3> sizes_;
+        std::array<size_t, 3> tiles_;
+
+        ROOT::Math::XYVector pixel_size_;
+        std::pair<double, double> thickness_domain_;
+
+        // Offsets and inverse sizes of the cells to convert positions into cell coordinates
+        std::array<double, 3> offset_;
+        std::array<double, 3> inverse_cell_size_;
+
+        bool interpolate_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_ELECTRIC_FIELD_GRID_H */
@@ -0,0 +1,26 @@
+/**
+ * @file
+ * @brief Implementation of the pool of recycled message buffers
+ *
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "BufferPool.hpp"
+
+using namespace allpix;
+
+std::atomic<BufferPool*> BufferPool::active_{nullptr};
+
+BufferPool::BufferPool(size_t max_buffers, size_t max_buffer_size)
+    : max_buffers_(max_buffers), max_buffer_size_(max_buffer_size) {}
+
+void BufferPool::set_active(BufferPool* pool) {
+    active_.store(pool, std::memory_order_release);
+}
+
+void BufferPool::set_max_buffer_size(size_t max_buffer_size) {
+    max_buffer_size_ = max_buffer_size;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file
+ * @brief Pool of recycled buffers for the data of messages
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_BUFFER_POOL_H
+#define ALLPIX_BUFFER_POOL_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <vector>
+
+namespace allpix {
+
+    /**
+     * @ingroup Managers
+     * @brief Pool of empty vectors which keep the memory of the data of earlier messages
+     *
+     * Messages return their data vector to the active pool when they are destroyed at the end of an event, after destroying
+     * the contained objects. Modules fetch these vectors again to fill the data of their messages in the next event, which
+     * avoids allocating and growing the storage for every event. The pool is owned by the \ref ModuleManager and only
+     * active during the event loop, buffers released outside of the event loop are freed as usual. Buffers with a capacity
+     * above the maximum buffer size, grown by a single exceptional event, are freed instead of being kept, such that the
+     * pool only holds the memory needed by typical events.
+     */
+    class BufferPool {
+        friend class ModuleManager;
+
+    public:
+        /**
+         * @brief Construct an empty pool
+         * @param max_buffers Maximum number of buffers kept for every type
+         * @param max_buffer_size Maximum capacity in bytes of a single kept buffer
+         */
+        explicit BufferPool(size_t max_buffers = 64, size_t max_buffer_size = 16777216);
+
+        /// @{
+        /**
+         * @brief Copying or moving the pool is not allowed
+         */
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+        BufferPool(BufferPool&&) = delete;
+        BufferPool& operator=(BufferPool&&) = delete;
+        /// @}
+
+        /**
+         * @brief Use default destructor
+         */
+        ~BufferPool() = default;
+
+        /**
+         * @brief Get an empty buffer for objects of a type from the active pool
+         * @return Empty vector, keeping the capacity of an earlier message if available
+         */
+        template <typename T> static std::vector<T> acquire();
+
+        /**
+         * @brief Return the buffer of a message to the active pool
+         * @param buffer Vector to return (cleared before it is stored)
+         * @note The buffer is freed if there is no active pool, if its capacity exceeds the maximum buffer size or if the
+         * pool is full
+         */
+        template <typename T> static void release(std::vector<T>&& buffer);
+
+    private:
+        /**
+         * @brief Type-erased storage of the buffers of a single type
+         */
+        class BaseBuffers {
+        public:
+            BaseBuffers() = default;
+            virtual ~BaseBuffers() = default;
+            BaseBuffers(const BaseBuffers&) = delete;
+            BaseBuffers& operator=(const BaseBuffers&) = delete;
+            BaseBuffers(BaseBuffers&&) = delete;
+            BaseBuffers& operator=(BaseBuffers&&) = delete;
+        };
+        template <typename T> class Buffers : public BaseBuffers {
+        public:
+            std::vector<std::vector<T>> buffers;
+        };
+
+        /**
+         * @brief Get the storage for buffers of a type
+         * @return Buffers of the type, created if they do not exist yet
+         * @warning The mutex of the pool should be locked by the caller
+         */
+        template <typename T> Buffers<T>& get_buffers();
+
+        /**
+         * @brief Set the pool used to acquire and release buffers
+         * @param pool Pool to use (or nullptr to disable recycling)
+         * @warning This method can only be called by the \ref ModuleManager
+         */
+        static void set_active(BufferPool* pool);
+
+        /**
+         * @brief Set the maximum capacity of the buffers kept in the pool
+         * @param max_buffer_size Maximum capacity in bytes of a single kept buffer
+         * @warning This method can only be called by the \ref ModuleManager before the pool is activated
+         */
+        void set_max_buffer_size(size_t max_buffer_size);
+
+        static std::atomic<BufferPool*> active_;
+
+        size_t max_buffers_;
+        size_t max_buffer_size_;
+        std::mutex mutex_;
+        std::map<std::type_index, std::unique_ptr<BaseBuffers>> buffers_;
+    };
+} // namespace allpix
+
+// Include template members
+#include "BufferPool.tpp"
+
+#endif /* ALLPIX_BUFFER_POOL_H */
@@ -0,0 +1,47 @@
+namespace allpix {
+    template <typename T> std::vector<T> BufferPool::acquire() {
+        BufferPool* pool = active_.load(std::memory_order_acquire);
+        if(pool == nullptr) {
+            return std::vector<T>();
+        }
+
+        std::lock_guard<std::mutex> lock(pool->mutex_);
+        auto& buffers = pool->get_buffers<T>().buffers;
+        if(buffers.empty()) {
+            return std::vector<T>();
+        }
+        std::vector<T> buffer = std::move(buffers.back());
+        buffers.pop_back();
+        return buffer;
+    }
+
+    /*
+     * Objects are destroyed before taking the lock of the pool. Buffers without any memory are not stored. Buffers above the
+     * maximum size are freed directly, such that their memory is not held until the caller destroys the moved-from vector.
+     */
+    template <typename T> void BufferPool::release(std::vector<T>&& buffer) {
+        BufferPool* pool = active_.load(std::memory_order_acquire);
+        if(pool == nullptr || buffer.capacity() == 0) {
+            return;
+        }
+        if(buffer.capacity() > pool->max_buffer_size_ / sizeof(T)) {
+            std::vector<T>().swap(buffer);
+            return;
+        }
+
+        buffer.clear();
+        std::lock_guard<std::mutex> lock(pool->mutex_);
+        auto& buffers = pool->get_buffers<T>().buffers;
+        if(buffers.size() < pool->max_buffers_) {
+            buffers.push_back(std::move(buffer));
+        }
+    }
+
+    template <typename T> BufferPool::Buffers<T>& BufferPool::get_buffers() {
+        auto& buffers = buffers_[typeid(T)];
+        if(buffers == nullptr) {
+            buffers = std::make_unique<Buffers<T>>();
+        }
+        return static_cast<Buffers<T>&>(*buffers);
+    }
+}
@@ -12,6 +12,7 @@
 
 #include <vector>
 
+#include "BufferPool.hpp"
 #include "core/geometry/Detector.hpp"
 #include "objects/Object.hpp"
 
@@ -85,6 +86,21 @@ namespace allpix {
          * @param detector Linked detector
          */
         Message(std::vector<T> data, std::shared_ptr<const Detector> detector);
+        /**
+         * @brief Return the data buffer to the \ref BufferPool "buffer pool" on destruction
+         */
+        ~Message() override;
+
+        ///@{
+        /**
+         * @brief Use default copy and move behaviour
+         */
+        Message(const Message&) = default;
+        Message& operator=(const Message&) = default;
+
+        Message(Message&&) noexcept = default;
+        Message& operator=(Message&&) noexcept = default;
+        ///@}
 
         /**
          * @brief Get a reference to the data in this message
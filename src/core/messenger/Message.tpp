@@ -5,6 +5,7 @@ namespace allpix {
     template <typename T>
     Message<T>::Message(std::vector<T> data, std::shared_ptr<const Detector> detector)
         : BaseMessage(detector), data_(std::move(data)) {}
+    template <typename T> Message<T>::~Message() { BufferPool::release(std::move(data_)); }
 
     template <typename T> const std::vector<T>& Message<T>::getData() const { return data_; }
 
@@ -85,6 +85,22 @@ bool Messenger::hasReceiver(Module* source, const std::shared_ptr<BaseMessage>&
  * Send messages to all specific listeners and also to all generic listeners (listening to all incoming messages)
  */
 void Messenger::dispatch_message(Module* source, const std::shared_ptr<BaseMessage>& message, std::string name) {
+    bool send = false;
+
+    // Use the precomputed receivers for messages dispatched under the output name if available
+    if(routing_frozen_ && name == "-") {
+        auto routes_iter = routing_table_.find(source);
+        if(routes_iter != routing_table_.end()) {
+            send = dispatch_routed(routes_iter->second, source, message);
+            if(!send) {
+                const BaseMessage* inst = message.get();
+                LOG(TRACE) << "Dispatched message " << allpix::demangle(typeid(*inst).name()) << " from "
+                           << source->getUniqueName() << " has no receivers!";
+            }
+            return;
+        }
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
 
     // Get the name of the output message
@@ -92,8 +108,6 @@ void Messenger::dispatch_message(Module* source, const std::shared_ptr<BaseMessa
         name = source->get_configuration().get<std::string>("output");
     }
 
-    bool send = false;
-
     // Send to specific listeners
     send = dispatch_message(source, message, name, name) || send;
 
@@ -126,7 +140,7 @@ bool Messenger::dispatch_message(Module* source,
         if(check_send(message.get(), delegate.get())) {
             LOG(TRACE) << "Sending message " << allpix::demangle(type_idx.name()) << " from " << source->getUniqueName()
                        << " to " << delegate->getUniqueName();
-            delegate->process(message, name);
+            process_message(delegate.get(), message, name);
             send = true;
         }
     }
@@ -137,7 +151,7 @@ bool Messenger::dispatch_message(Module* source,
         if(check_send(message.get(), delegate.get())) {
             LOG(TRACE) << "Sending message " << allpix::demangle(type_idx.name()) << " from " << source->getUniqueName()
                        << " to generic listener " << delegate->getUniqueName();
-            delegate->process(message, name);
+            process_message(delegate.get(), message, name);
             send = true;
         }
     }
@@ -145,8 +159,192 @@ bool Messenger::dispatch_message(Module* source,
     return send;
 }
 
+/**
+ * Used while dispatching without the routing table, with the global lock taken. While the routing table is frozen, the
+ * receiver is also locked, because other threads can dispatch to the same receiver using the routing table.
+ */
+void Messenger::process_message(BaseDelegate* delegate,
+                                const std::shared_ptr<BaseMessage>& message,
+                                const std::string& name) {
+    Module* module = std::get<3>(delegate_to_iterator_.at(delegate));
+    std::mutex* mutex = (routing_frozen_ ? receiver_mutexes_.at(module).get() : nullptr);
+    process_message(delegate, module, mutex, message, name);
+}
+
+/**
+ * The routes are precomputed in the same order as the delegates are visited by the generic dispatch: the listeners of the
+ * specific type and the base message listeners for the output name, followed by those listening to all names. Only the
+ * detector of the message has to be compared when dispatching, which is done by comparing the pointers as every detector
+ * only exists once in the \ref GeometryManager.
+ */
+void Messenger::freeze_routing(const std::vector<Module*>& modules) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Create a lock for every receiving module
+    receiver_mutexes_.clear();
+    for(auto& delegate_iter : delegate_to_iterator_) {
+        auto& mutex = receiver_mutexes_[std::get<3>(delegate_iter.second)];
+        if(mutex == nullptr) {
+            mutex = std::make_unique<std::mutex>();
+        }
+    }
+
+    // Collect the routes for a list of delegates
+    auto add_routes = [this](std::vector<Route>& routes, const std::list<std::unique_ptr<BaseDelegate>>& delegates) {
+        for(auto& delegate : delegates) {
+            Module* module = std::get<3>(delegate_to_iterator_.at(delegate.get()));
+            routes.push_back(
+                Route{delegate.get(), module, delegate->getDetector().get(), receiver_mutexes_.at(module).get()});
+        }
+    };
+    auto find_delegates = [this](std::type_index type, const std::string& name) {
+        static const std::list<std::unique_ptr<BaseDelegate>> empty;
+        auto type_iter = delegates_.find(type);
+        if(type_iter == delegates_.end()) {
+            return std::cref(empty);
+        }
+        auto name_iter = type_iter->second.find(name);
+        return std::cref(name_iter == type_iter->second.end() ? empty : name_iter->second);
+    };
+
+    routing_table_.clear();
+    std::type_index base_type = typeid(BaseMessage);
+    for(auto& source : modules) {
+        SourceRoutes source_routes;
+        source_routes.name = source->get_configuration().get<std::string>("output");
+
+        // Messages of a type without specific listeners only reach the base message listeners
+        add_routes(source_routes.generic_routes, find_delegates(base_type, source_routes.name));
+        add_routes(source_routes.generic_routes, find_delegates(base_type, "*"));
+
+        for(auto& type_delegates : delegates_) {
+            if(type_delegates.first == base_type) {
+                continue;
+            }
+
+            std::vector<Route> routes;
+            add_routes(routes, find_delegates(type_delegates.first, source_routes.name));
+            add_routes(routes, find_delegates(base_type, source_routes.name));
+            add_routes(routes, find_delegates(type_delegates.first, "*"));
+            add_routes(routes, find_delegates(base_type, "*"));
+            if(routes.size() != source_routes.generic_routes.size()) {
+                source_routes.typed_routes.emplace_back(type_delegates.first, std::move(routes));
+            }
+        }
+        routing_table_.emplace(source, std::move(source_routes));
+    }
+    routing_frozen_ = true;
+}
+
+bool Messenger::dispatch_routed(const SourceRoutes& routes, Module* source, const std::shared_ptr<BaseMessage>& message) {
+    const BaseMessage* inst = message.get();
+    std::type_index type_idx = typeid(*inst);
+
+    // Find the routes for the type of the message
+    const std::vector<Route>* type_routes = &routes.generic_routes;
+    for(auto& typed_routes : routes.typed_routes) {
+        if(typed_routes.first == type_idx) {
+            type_routes = &typed_routes.second;
+            break;
+        }
+    }
+
+    bool send = false;
+    const Detector* detector = inst->getDetector().get();
+    for(auto& route : *type_routes) {
+        if(route.detector != nullptr && route.detector != detector) {
+            continue;
+        }
+
+        LOG(TRACE) << "Sending message " << allpix::demangle(type_idx.name()) << " from " << source->getUniqueName()
+                   << " to " << route.delegate->getUniqueName();
+        process_message(route.delegate, route.module, route.mutex, message, routes.name);
+        send = true;
+    }
+    return send;
+}
+
+/**
+ * Messages are directly processed by the delegate, unless delivery is delayed for the calling thread. In that case the
+ * message is stored with the receiving module until the \ref ModuleManager delivers it before running that module.
+ */
+void Messenger::process_message(BaseDelegate* delegate,
+                                Module* module,
+                                std::mutex* mutex,
+                                const std::shared_ptr<BaseMessage>& message,
+                                const std::string& name) {
+    DelayedMessages* delayed_messages = get_delayed_messages();
+    if(delayed_messages == nullptr) {
+        if(mutex == nullptr) {
+            delegate->process(message, name);
+        } else {
+            std::lock_guard<std::mutex> lock(*mutex);
+            delegate->process(message, name);
+        }
+        return;
+    }
+
+    (*delayed_messages)[module].push_back(DelayedMessage{delegate, message, name});
+}
+
+Messenger::DelayedMessages*& Messenger::get_delayed_messages() {
+    thread_local DelayedMessages* delayed_messages = nullptr;
+    return delayed_messages;
+}
+void Messenger::set_delayed_messages(DelayedMessages* messages) {
+    get_delayed_messages() = messages;
+}
+
+/**
+ * Messages are delivered in the order they were dispatched. The delivered messages are removed from the event storage.
+ */
+void Messenger::deliver_delayed_messages(DelayedMessages& messages, Module* module) {
+    auto iter = messages.find(module);
+    if(iter == messages.end()) {
+        return;
+    }
+
+    for(auto& delayed_message : iter->second) {
+        delayed_message.delegate->process(delayed_message.message, delayed_message.name);
+    }
+    messages.erase(iter);
+}
+
+/**
+ * Assumes that the source dispatches messages of all types under its output name. Messages of a module bound to a detector
+ * can only be received by delegates of modules bound to the same detector or to no detector at all, while unique modules can
+ * dispatch messages for any detector.
+ */
+bool Messenger::can_receive(Module* source, Module* receiver) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::string output = source->get_configuration().get<std::string>("output");
+    for(auto& delegate_iter : delegate_to_iterator_) {
+        if(std::get<3>(delegate_iter.second) != receiver) {
+            continue;
+        }
+
+        // Check if the name of the messages matches
+        const std::string& name = std::get<1>(delegate_iter.second);
+        if(name != "*" && name != output) {
+            continue;
+        }
+
+        // Check if the messages can belong to the detector of the receiver
+        auto detector = delegate_iter.first->getDetector();
+        if(detector != nullptr && source->getDetector() != nullptr &&
+           detector->getName() != source->getDetector()->getName()) {
+            continue;
+        }
+
+        return true;
+    }
+    return false;
+}
+
 void Messenger::add_delegate(const std::type_info& message_type, Module* module, std::unique_ptr<BaseDelegate> delegate) {
     std::lock_guard<std::mutex> lock(mutex_);
+    routing_frozen_ = false;
 
     // Register generic or specific delegate depending on flag
     std::string message_name;
@@ -160,7 +358,7 @@ void Messenger::add_delegate(const std::type_info& message_type, Module* module,
     delegates_[std::type_index(message_type)][message_name].push_back(std::move(delegate));
     auto delegate_iter = --delegates_[std::type_index(message_type)][message_name].end();
     delegate_to_iterator_.emplace(delegate_iter->get(),
-                                  std::make_tuple(std::type_index(message_type), message_name, delegate_iter));
+                                  std::make_tuple(std::type_index(message_type), message_name, delegate_iter, module));
 
     // Add delegate to the module itself
     module->add_delegate(this, delegate_iter->get());
@@ -171,6 +369,7 @@ void Messenger::add_delegate(const std::type_info& message_type, Module* module,
  */
 void Messenger::remove_delegate(BaseDelegate* delegate) {
     std::lock_guard<std::mutex> lock(mutex_);
+    routing_frozen_ = false;
 
     auto iter = delegate_to_iterator_.find(delegate);
     if(iter == delegate_to_iterator_.end()) {
@@ -13,8 +13,13 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
 #include <typeindex>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "Message.hpp"
 #include "core/module/Module.hpp"
@@ -31,6 +36,7 @@ namespace allpix {
      */
     class Messenger {
         friend class Module;
+        friend class ModuleManager;
 
     public:
         /**
@@ -126,6 +132,112 @@ namespace allpix {
         void dispatchMessage(Module* source, std::shared_ptr<T> message, const std::string& name = "-");
 
     private:
+        /**
+         * @brief Message waiting to be delivered to a delegate of a module
+         */
+        struct DelayedMessage {
+            BaseDelegate* delegate;
+            std::shared_ptr<BaseMessage> message;
+            std::string name;
+        };
+        /**
+         * @brief Messages of a single event grouped by the module that should receive them
+         */
+        using DelayedMessages = std::map<Module*, std::vector<DelayedMessage>>;
+
+        /**
+         * @brief Precomputed receiver of messages dispatched by a module
+         */
+        struct Route {
+            BaseDelegate* delegate;
+            Module* module;
+            // Detector of the delegate (or null pointer if the delegate accepts messages of all detectors)
+            const Detector* detector;
+            // Lock serializing the messages delivered to the receiving module
+            std::mutex* mutex;
+        };
+        /**
+         * @brief Receivers of all messages dispatched by a module under its output name
+         */
+        struct SourceRoutes {
+            std::string name;
+            std::vector<std::pair<std::type_index, std::vector<Route>>> typed_routes;
+            std::vector<Route> generic_routes;
+        };
+
+        /**
+         * @brief Build the routing table and use it to dispatch messages until delegates are added or removed
+         * @param modules All modules that can dispatch messages
+         * @warning This method can only be called by the \ref ModuleManager before starting the event loop
+         * @warning No delegates should be added or removed while messages are dispatched using the routing table
+         */
+        void freeze_routing(const std::vector<Module*>& modules);
+
+        /**
+         * @brief Dispatch a message to the receivers precomputed in the routing table
+         * @param routes Routes of the dispatching module
+         * @param source Dispatching module
+         * @param message Message to dispatch
+         * @return True if the message has been sent to any receiver, false otherwise
+         */
+        bool dispatch_routed(const SourceRoutes& routes, Module* source, const std::shared_ptr<BaseMessage>& message);
+
+        /**
+         * @brief Delay delivery of all messages dispatched from the calling thread
+         * @param messages Storage for the delayed messages of the current event (or null pointer to deliver directly)
+         * @warning This method can only be called by the \ref ModuleManager
+         *
+         * Used to run multiple events concurrently: the messages of every event are kept separate until the receiving module
+         * is executed for that event.
+         */
+        void set_delayed_messages(DelayedMessages* messages);
+
+        /**
+         * @brief Deliver all delayed messages of an event to the delegates of a module
+         * @param messages Delayed messages of the event
+         * @param module Module to deliver the messages to
+         * @warning This method can only be called by the \ref ModuleManager
+         */
+        void deliver_delayed_messages(DelayedMessages& messages, Module* module);
+
+        /**
+         * @brief Get the storage for delayed messages of the calling thread
+         * @return Delayed message storage or null pointer if messages should be delivered directly
+         */
+        static DelayedMessages*& get_delayed_messages();
+
+        /**
+         * @brief Process a message by a registered delegate or delay it if requested by the calling thread
+         * @param delegate Delegate that should process the message
+         * @param message Message to process
+         * @param name Name of the message
+         */
+        void process_message(BaseDelegate* delegate, const std::shared_ptr<BaseMessage>& message, const std::string& name);
+        /**
+         * @brief Process a message by a delegate or delay it if requested by the calling thread
+         * @param delegate Delegate that should process the message
+         * @param module Module linked to the delegate
+         * @param mutex Lock to take while processing the message (or null pointer if no other thread can dispatch to it)
+         * @param message Message to process
+         * @param name Name of the message
+         */
+        void process_message(BaseDelegate* delegate,
+                             Module* module,
+                             std::mutex* mutex,
+                             const std::shared_ptr<BaseMessage>& message,
+                             const std::string& name);
+
+        /**
+         * @brief Check if a module can receive any message dispatched by another module
+         * @param source Module that may dispatch messages
+         * @param receiver Module that may receive messages
+         * @return True if any delegate of the receiver could process a message of the source, false otherwise
+         * @warning This method can only be called by the \ref ModuleManager after all modules are constructed
+         *
+         * The type of the dispatched messages is not known in advance, thus only the names and detectors are compared.
+         */
+        bool can_receive(Module* source, Module* receiver) const;
+
         /**
          * @brief Add a delegate to the listeners
          * @param message_type Type the delegate listens to
@@ -162,13 +274,18 @@ namespace allpix {
                               const std::string& id);
 
         using DelegateMap = std::map<std::type_index, std::map<std::string, std::list<std::unique_ptr<BaseDelegate>>>>;
-        using DelegateIteratorMap =
-            std::map<BaseDelegate*,
-                     std::tuple<std::type_index, std::string, std::list<std::unique_ptr<BaseDelegate>>::iterator>>;
+        using DelegateIteratorMap = std::map<
+            BaseDelegate*,
+            std::tuple<std::type_index, std::string, std::list<std::unique_ptr<BaseDelegate>>::iterator, Module*>>;
 
         DelegateMap delegates_;
         DelegateIteratorMap delegate_to_iterator_;
 
+        // Routing table, only read without locking while it is frozen
+        bool routing_frozen_{false};
+        std::unordered_map<Module*, SourceRoutes> routing_table_;
+        std::map<Module*, std::unique_ptr<std::mutex>> receiver_mutexes_;
+
         mutable std::mutex mutex_;
     };
 } // namespace allpix
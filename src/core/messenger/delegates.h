@@ -136,7 +136,7 @@ namespace allpix {
          * @param msg Message to process
          * @param name Name of the message
          */
-        virtual void process(std::shared_ptr<BaseMessage> msg, std::string name) = 0;
+        virtual void process(std::shared_ptr<BaseMessage> msg, const std::string& name) = 0;
 
         /**
          * @brief Reset the delegate and set it not satisfied again
@@ -203,7 +203,7 @@ namespace allpix {
          * @brief Stores the received message in the delegate until the end of the event
          * @param msg Message to store
          */
-        void process(std::shared_ptr<BaseMessage> msg, std::string) override {
+        void process(std::shared_ptr<BaseMessage> msg, const std::string&) override {
             // Store the message and mark as processed
             messages_.push_back(msg);
             this->set_processed();
@@ -252,7 +252,7 @@ namespace allpix {
          * @warning The listener function is called directly from the delegate, no heavy processing should be done in the
          *          listener function
          */
-        void process(std::shared_ptr<BaseMessage> msg, std::string) override {
+        void process(std::shared_ptr<BaseMessage> msg, const std::string&) override {
 #ifndef NDEBUG
             // The type names should have been correctly resolved earlier
             const BaseMessage* inst = msg.get();
@@ -292,7 +292,7 @@ namespace allpix {
          * @warning The listener function is called directly from the delegate, no heavy processing should be done in the
          *          listener function
          */
-        void process(std::shared_ptr<BaseMessage> msg, std::string name) override {
+        void process(std::shared_ptr<BaseMessage> msg, const std::string& name) override {
             // Pass the message and mark as processed
             (this->obj_->*method_)(std::static_pointer_cast<BaseMessage>(msg), name);
             this->set_processed();
@@ -326,7 +326,7 @@ namespace allpix {
          *
          * The saved value is overwritten if the \ref MsgFlags::ALLOW_OVERWRITE "ALLOW_OVERWRITE" flag is enabled.
          */
-        void process(std::shared_ptr<BaseMessage> msg, std::string) override {
+        void process(std::shared_ptr<BaseMessage> msg, const std::string&) override {
 #ifndef NDEBUG
             // The type names should have been correctly resolved earlier
             const BaseMessage* inst = msg.get();
@@ -382,7 +382,7 @@ namespace allpix {
          * @brief Adds the message to the bound vector
          * @param msg Message to process
          */
-        void process(std::shared_ptr<BaseMessage> msg, std::string) override {
+        void process(std::shared_ptr<BaseMessage> msg, const std::string&) override {
 #ifndef NDEBUG
             // The type names should have been correctly resolved earlier
             const BaseMessage* inst = msg.get();
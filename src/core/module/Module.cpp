@@ -24,9 +24,30 @@
 
 using namespace allpix;
 
+// Finalizer of the SplitMix64 generator to mix the bits of a seed
+static uint64_t mix_seed(uint64_t value) {
+    value += 0x9e3779b97f4a7c15;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+// FNV-1a hash of a name, to ensure the seeds derived from it are identical on all platforms
+static uint64_t name_hash(const std::string& name) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(auto chr : name) {
+        hash ^= static_cast<unsigned char>(chr);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
 Module::Module(Configuration config) : Module(std::move(config), nullptr) {}
 Module::Module(Configuration config, std::shared_ptr<Detector> detector)
-    : config_(std::move(config)), detector_(std::move(detector)) {}
+    : config_(std::move(config)), detector_(std::move(detector)) {
+    // The seed and the unique name are set by the module manager before the module is constructed
+    event_seed_base_ = mix_seed(config_.get<uint64_t>("_seed", 0) ^ name_hash(config_.get<std::string>("_unique_name", "")));
+}
 /**
  * @note The remove_delegate can throw in theory, but this should never happen in practice
  */
@@ -118,6 +139,14 @@ uint64_t Module::getRandomSeed() {
     return random_generator_();
 }
 
+/**
+ * The event seed is derived from the module seed (generated from the global seed), a hash of the unique module name and the
+ * event number. The first two are mixed once when the module is constructed.
+ */
+uint64_t Module::getEventSeed(unsigned int event_num) const {
+    return mix_seed(event_seed_base_ + event_num);
+}
+
 /**
  * @throws InvalidModuleActionException If the thread pool is accessed outside the run-method
  * @warning Any multithreaded task should be carefully checked to ensure it is thread-safe
@@ -181,6 +210,12 @@ void Module::reset_delegates() {
         delegate.second->reset();
     }
 }
+void Module::resolve_parameters() {
+    for(auto& binding : parameter_bindings_) {
+        binding();
+    }
+}
+
 bool Module::check_delegates() {
     for(auto& delegate : delegates_) {
         // Return false if any delegate is not satisfied
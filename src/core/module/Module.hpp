@@ -10,6 +10,7 @@
 #ifndef ALLPIX_MODULE_H
 #define ALLPIX_MODULE_H
 
+#include <functional>
 #include <memory>
 #include <random>
 #include <string>
@@ -187,6 +188,16 @@ namespace allpix {
          */
         uint64_t getRandomSeed();
 
+        /**
+         * @brief Get seed to initialize random generators for a single event
+         * @param event_num Number of the event to get the seed for
+         * @return Seed depending only on the module seed, the unique name of the module and the event number
+         *
+         * Modules should reseed their generators with this seed at the start of every event, to make the results independent
+         * of the order in which the events are processed.
+         */
+        uint64_t getEventSeed(unsigned int event_num) const;
+
         /**
          * @brief Get thread pool to submit asynchronous tasks to
          */
@@ -234,6 +245,19 @@ namespace allpix {
          */
         void enable_parallelization();
 
+        /**
+         * @brief Bind a member variable to the value of a configuration key
+         * @param config Configuration to read the key from
+         * @param key Key to bind the value of
+         * @param value Member variable to store the value of the key in
+         *
+         * The key is only converted once, when the bindings are resolved directly before the \ref Module::init() method is
+         * executed. Modules should bind all parameters used in their event loop in the constructor, after setting their
+         * default values, instead of fetching them from the configuration for every event.
+         * @warning The configuration and the bound variable should both outlive the module, usually both are members
+         */
+        template <typename T> void bind_parameter(const Configuration& config, std::string key, T& value);
+
     private:
         /**
          * @brief Set the module identifier for internal use
@@ -284,8 +308,18 @@ namespace allpix {
         bool check_delegates();
         std::vector<std::pair<Messenger*, BaseDelegate*>> delegates_;
 
+        /**
+         * @brief Convert the values of all bound configuration keys and store them in their variables
+         * @throws MissingKeyError If a bound key is not defined
+         * @throws InvalidKeyError If a bound key cannot be converted to the type of its variable
+         */
+        void resolve_parameters();
+        std::vector<std::function<void()>> parameter_bindings_;
+
         bool initialized_random_generator_{false};
         std::mt19937_64 random_generator_;
+        // Module seed mixed with the hash of the unique name, from which the event seeds are derived
+        uint64_t event_seed_base_{};
 
         std::shared_ptr<Detector> detector_;
 
@@ -294,4 +328,7 @@ namespace allpix {
 
 } // namespace allpix
 
+// Include template members
+#include "Module.tpp"
+
 #endif /* ALLPIX_MODULE_H */
@@ -0,0 +1,19 @@
+/**
+ * @file
+ * @brief Template implementation of module
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+namespace allpix {
+    /**
+     * The binding stores a reference to the configuration, such that default values set after the binding are still taken
+     * into account when the binding is resolved.
+     */
+    template <typename T> void Module::bind_parameter(const Configuration& config, std::string key, T& value) {
+        parameter_bindings_.emplace_back(
+            [&config, key = std::move(key), &value]() { value = config.get<T>(key); });
+    }
+} // namespace allpix
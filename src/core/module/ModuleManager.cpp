@@ -15,13 +15,19 @@
 
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <fstream>
+#include <future>
+#include <iomanip>
 #include <limits>
+#include <mutex>
 #include <random>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 #include <TProcessID.h>
 #include <TSystem.h>
@@ -56,6 +62,13 @@ void ModuleManager::load(Messenger* messenger,
                          std::mt19937_64& seeder) {
     std::vector<Configuration> configs = conf_manager->getConfigurations();
     global_config_ = conf_manager->getGlobalConfiguration();
+    messenger_ = messenger;
+
+    // Start recording a timeline of the execution if requested
+    if(!global_config_.get<std::string>("trace_file", "").empty()) {
+        tracer_ = std::make_unique<Tracer>();
+        tracer_->setThreadName("Main thread");
+    }
 
     auto path = std::string(gSystem->pwd()) + "/" + global_config_.get<std::string>("root_file", "modules") + ".root";
     modules_file_ = std::make_unique<TFile>(path.c_str(), "RECREATE");
@@ -64,6 +77,12 @@ void ModuleManager::load(Messenger* messenger,
     }
     modules_file_->cd();
 
+    // Number of threads available to the modules (zero if multithreading is disabled)
+    unsigned int workers = 0;
+    if(global_config_.get<bool>("experimental_multithreading", false)) {
+        workers = global_config_.get<unsigned int>("workers", std::max(std::thread::hardware_concurrency(), 1u));
+    }
+
     // Loop through all non-global configurations
     for(auto& config : configs) {
         // Load library for each module. Libraries are named (by convention + CMAKE) libAllpixModule Name.suffix
@@ -174,6 +193,8 @@ void ModuleManager::load(Messenger* messenger,
         // Add the global internal parameters to the configuration
         std::string global_dir = gSystem->pwd();
         config.set<std::string>("_global_dir", global_dir);
+        config.set<unsigned int>("_number_of_events", global_config_.get<unsigned int>("number_of_events", 1u));
+        config.set<unsigned int>("_workers", workers);
 
         // Set default input and output name
         config.setDefault<std::string>("input", "");
@@ -203,7 +224,7 @@ void ModuleManager::load(Messenger* messenger,
                     LOG(TRACE) << "Replacing model instance " << iter->first.getUniqueName()
                                << " with instance with higher priority.";
 
-                    module_execution_time_.erase(iter->second->get());
+                    module_statistics_.erase(iter->second->get());
                     iter->second = modules_.erase(iter->second);
                     iter = id_to_module_.erase(iter);
                 } else {
@@ -287,7 +308,10 @@ std::pair<ModuleIdentifier, Module*> ModuleManager::create_unique_modules(
     set_module_after(old_settings);
     // Update execution time
     auto end = std::chrono::steady_clock::now();
-    module_execution_time_[module] += static_cast<std::chrono::duration<long double>>(end - start).count();
+    module_statistics_[module].construction_time = static_cast<std::chrono::duration<long double>>(end - start).count();
+    if(tracer_ != nullptr) {
+        tracer_->record("construct", identifier.getUniqueName(), 0, start, end);
+    }
 
     // Set the module directory afterwards to catch invalid access in constructor
     module->get_configuration().set<std::string>("_output_dir", output_dir);
@@ -402,7 +426,11 @@ std::vector<std::pair<ModuleIdentifier, Module*>> ModuleManager::create_detector
         set_module_after(old_settings);
         // Update execution time
         auto end = std::chrono::steady_clock::now();
-        module_execution_time_[module] += static_cast<std::chrono::duration<long double>>(end - start).count();
+        module_statistics_[module].construction_time =
+            static_cast<std::chrono::duration<long double>>(end - start).count();
+        if(tracer_ != nullptr) {
+            tracer_->record("construct", instance.second.getUniqueName(), 0, start, end);
+        }
 
         // Set the module directory afterwards to catch invalid access in constructor
         module->get_configuration().set<std::string>("_output_dir", output_dir);
@@ -522,7 +550,8 @@ void ModuleManager::init() {
         auto old_settings = set_module_before(module->get_identifier().getUniqueName(), module->get_configuration());
         // Change to our ROOT directory
         module->getROOTDirectory()->cd();
-        // Init module
+        // Resolve the bound parameters and init module
+        module->resolve_parameters();
         module->init();
         // Reset delegates
         LOG(TRACE) << "Resetting messages";
@@ -532,20 +561,73 @@ void ModuleManager::init() {
         set_module_after(old_settings);
         // Update execution time
         auto end = std::chrono::steady_clock::now();
-        module_execution_time_[module.get()] += static_cast<std::chrono::duration<long double>>(end - start).count();
+        module_statistics_[module.get()].init_time = static_cast<std::chrono::duration<long double>>(end - start).count();
+        if(tracer_ != nullptr) {
+            tracer_->record("init", module->getUniqueName(), 0, start, end);
+        }
     }
     LOG_PROGRESS(STATUS, "INIT_LOOP") << "Initialized " << modules_.size() << " module instantiations";
 }
 
 /**
- * Initializes the thread pool for excuting multiple modules and module tasks in parallel. The run for a module is skipped if
- * its delegates are not \ref Module::check_delegates() "satisfied". Sets the section header and logging settings before
- * executing the \ref Module::run() function. \ref Module::reset_delegates() "Resets" the delegates and the logging after
- * initialization
+ * Skips the module if its delegates are not \ref Module::check_delegates() "satisfied". Sets the section header and logging
+ * settings before executing the \ref Module::run() function. \ref Module::reset_delegates() "Resets" the delegates and the
+ * logging after running the module.
+ */
+void ModuleManager::run_module(Module* module, unsigned int event_num, unsigned int number_of_events) {
+    LOG_PROGRESS(TRACE, "EVENT_LOOP") << "Running event " << event_num << " of " << number_of_events << " ["
+                                      << module->get_identifier().getUniqueName() << "]";
+    // Only look up the statistics, the map itself is not modified while running events
+    auto& statistics = module_statistics_.at(module);
+
+    // Check if module is satisfied to run
+    if(!module->check_delegates()) {
+        LOG(TRACE) << "Not all required messages are received for " << module->get_identifier().getUniqueName()
+                   << ", skipping module!";
+        // Reset the delegates to not leak messages into the next event
+        module->reset_delegates();
+        statistics.skipped_events.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Get current time
+    auto start = std::chrono::steady_clock::now();
+    // Trace the module run, tasks submitted by the module are attributed to the same event
+    Tracer::Span span(tracer_.get(), "run", (tracer_ != nullptr ? module->getUniqueName() : std::string()), event_num);
+    // Set run module section header
+    std::string old_section_name = Log::getSection();
+    std::string section_name = "R:";
+    section_name += module->get_identifier().getUniqueName();
+    Log::setSection(section_name);
+    // Set module specific settings
+    auto old_settings = set_module_before(module->get_identifier().getUniqueName(), module->get_configuration());
+    // Change to ROOT directory is not thread safe, only do this for module without parallelization support
+    if(!module->canParallelize()) {
+        // DEPRECATED: Switching to the directory should be removed, but can break current modules
+        module->getROOTDirectory()->cd();
+    }
+    // Run module
+    module->run(event_num);
+    // Resetting delegates
+    LOG(TRACE) << "Resetting messages";
+    module->reset_delegates();
+    // Reset logging
+    Log::setSection(old_section_name);
+    set_module_after(old_settings);
+    // Update execution time
+    auto end = std::chrono::steady_clock::now();
+    statistics.run_latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
+}
+
+/**
+ * Initializes the thread pool for excuting multiple modules and module tasks in parallel. Events are processed one after
+ * each other, unless multiple concurrent events are requested, in which case the events are processed by
+ * \ref ModuleManager::run_concurrent_events "multiple event threads".
  */
 void ModuleManager::run() {
     global_config_.setDefault("experimental_multithreading", false);
     unsigned int threads_num;
+    unsigned int concurrent_events = 1;
 
     if(global_config_.get<bool>("experimental_multithreading")) {
         // Try to fetch a suitable number of workers if multithreading is enabled
@@ -555,11 +637,28 @@ void ModuleManager::run() {
         }
         LOG(WARNING) << "Experimental multithreading enabled - using " << threads_num << " worker threads.";
         --threads_num;
+
+        // Fetch the number of events to simulate at the same time
+        concurrent_events = global_config_.get<unsigned int>("concurrent_events", 1u);
+        if(concurrent_events == 0) {
+            throw InvalidValueError(
+                global_config_, "concurrent_events", "number of concurrent events should be strictly more than zero");
+        }
+        if(concurrent_events > 1) {
+            LOG(WARNING) << "Experimental event parallelism enabled - simulating " << concurrent_events
+                         << " events concurrently.";
+        }
     } else {
         // Default to no additional thread without multithreading
         threads_num = 0;
     }
 
+    // Recycle the data buffers of the messages until the event loop is left, after the thread pool is destroyed
+    buffer_pool_.set_max_buffer_size(global_config_.get<size_t>("buffer_pool_max_size", 16777216));
+    BufferPool::set_active(&buffer_pool_);
+    auto buffer_pool_guard = std::unique_ptr<BufferPool, void (*)(BufferPool*)>(
+        &buffer_pool_, [](BufferPool*) { BufferPool::set_active(nullptr); });
+
     // Creates the thread pool
     LOG(DEBUG) << "Initializing thread pool with " << threads_num << " additional thread(s)";
     std::vector<Module*> module_list;
@@ -571,93 +670,96 @@ void ModuleManager::run() {
         Log::setReportingLevel(log_level);
         Log::setFormat(log_format);
     };
-    std::shared_ptr<ThreadPool> thread_pool = std::make_shared<ThreadPool>(threads_num, module_list, init_function);
+    std::shared_ptr<ThreadPool> thread_pool =
+        std::make_shared<ThreadPool>(threads_num, module_list, init_function, tracer_.get());
     for(auto& module : modules_) {
         module->set_thread_pool(thread_pool);
     }
 
+    // No delegates are added or removed during the event loop, so the receivers of all modules can be precomputed
+    messenger_->freeze_routing(module_list);
+
+    // Find the modules every module receives messages from, within the same section of modules that can run in parallel
+    std::vector<std::vector<size_t>> dependents(module_list.size());
+    std::vector<unsigned int> dependency_count(module_list.size(), 0);
+    size_t section_start = 0;
+    for(size_t index = 0; index < module_list.size(); ++index) {
+        if(!module_list[index]->canParallelize()) {
+            section_start = index + 1;
+            continue;
+        }
+        for(size_t source = section_start; source < index; ++source) {
+            if(messenger_->can_receive(module_list[source], module_list[index])) {
+                LOG(TRACE) << "Module " << module_list[index]->getUniqueName() << " depends on "
+                           << module_list[source]->getUniqueName();
+                dependents[source].push_back(index);
+                ++dependency_count[index];
+            }
+        }
+    }
+    auto remaining_dependencies = std::make_unique<std::atomic<unsigned int>[]>(module_list.size());
+
     // Loop over all the events
     auto start_time = std::chrono::steady_clock::now();
     global_config_.setDefault<unsigned int>("number_of_events", 1u);
     auto number_of_events = global_config_.get<unsigned int>("number_of_events");
-    for(unsigned int i = 0; i < number_of_events; ++i) {
-        // Check for termination
-        if(terminate_) {
-            LOG(INFO) << "Interrupting event loop after " << i << " events because of request to terminate";
-            number_of_events = i;
-            global_config_.set<unsigned int>("number_of_events", i);
-            break;
-        }
-
-        LOG_PROGRESS(STATUS, "EVENT_LOOP") << "Running event " << (i + 1) << " of " << number_of_events;
+    if(concurrent_events > 1) {
+        // Run multiple events at the same time in separate event threads
+        number_of_events = run_concurrent_events(number_of_events, concurrent_events, init_function);
+        global_config_.set<unsigned int>("number_of_events", number_of_events);
+    } else {
+        // Run the events one after each other
+        for(unsigned int i = 0; i < number_of_events; ++i) {
+            // Check for termination
+            if(terminate_) {
+                LOG(INFO) << "Interrupting event loop after " << i << " events because of request to terminate";
+                number_of_events = i;
+                global_config_.set<unsigned int>("number_of_events", i);
+                break;
+            }
 
-        // Get object count for linking objects in current event
-        auto save_id = TProcessID::GetObjectCount();
+            LOG_PROGRESS(STATUS, "EVENT_LOOP") << "Running event " << (i + 1) << " of " << number_of_events;
 
-        std::string module_name;
-        if(!modules_.empty()) {
-            module_name = modules_.front()->get_identifier().getName();
-        }
-        for(auto& module : modules_) {
-            // Execute all remaining jobs in the thread pool when switching to a new module type
-            if(module->get_identifier().getName() != module_name) {
-                module_name = module->get_identifier().getName();
-                thread_pool->execute_all();
-            }
+            // Trace the full event, including the waits for the thread pool
+            Tracer::Span event_span(tracer_.get(), "event", "Event " + std::to_string(i + 1), i + 1);
 
-            auto execute_module = [ module = module.get(), event_num = i + 1, this, number_of_events ]() {
-                LOG_PROGRESS(TRACE, "EVENT_LOOP") << "Running event " << event_num << " of " << number_of_events << " ["
-                                                  << module->get_identifier().getUniqueName() << "]";
-                // Check if module is satisfied to run
-                if(!module->check_delegates()) {
-                    LOG(TRACE) << "Not all required messages are received for " << module->get_identifier().getUniqueName()
-                               << ", skipping module!";
-                    return;
-                }
+            // Get object count for linking objects in current event
+            auto save_id = TProcessID::GetObjectCount();
 
-                // Get current time
-                auto start = std::chrono::steady_clock::now();
-                // Set run module section header
-                std::string old_section_name = Log::getSection();
-                std::string section_name = "R:";
-                section_name += module->get_identifier().getUniqueName();
-                Log::setSection(section_name);
-                // Set module specific settings
-                auto old_settings = set_module_before(module->get_identifier().getUniqueName(), module->get_configuration());
-                // Change to ROOT directory is not thread safe, only do this for module without parallelization support
-                if(!module->canParallelize()) {
-                    // DEPRECATED: Switching to the directory should be removed, but can break current modules
-                    module->getROOTDirectory()->cd();
+            // Run a module and submit the modules depending on it once all their dependencies are finished
+            std::function<void(size_t)> execute_module = [&, event_num = i + 1](size_t index) {
+                run_module(module_list[index], event_num, number_of_events);
+                for(auto dependent : dependents[index]) {
+                    if(--remaining_dependencies[dependent] == 0) {
+                        thread_pool->submit_module_function([&execute_module, dependent]() { execute_module(dependent); },
+                                                            module_list[index]);
+                    }
                 }
-                // Run module
-                module->run(event_num);
-                // Resetting delegates
-                LOG(TRACE) << "Resetting messages";
-                module->reset_delegates();
-                // Reset logging
-                Log::setSection(old_section_name);
-                set_module_after(old_settings);
-                // Update execution time
-                auto end = std::chrono::steady_clock::now();
-                module_execution_time_[module] += static_cast<std::chrono::duration<long double>>(end - start).count();
             };
 
-            if(module->canParallelize()) {
-                // Submit the module function
-                thread_pool->submit_module_function(execute_module);
-            } else {
-                // Finish thread pool
-                thread_pool->execute_all();
-                // Execute current module
-                execute_module();
+            for(size_t index = 0; index < module_list.size(); ++index) {
+                remaining_dependencies[index] = dependency_count[index];
+            }
+            for(size_t index = 0; index < module_list.size(); ++index) {
+                if(module_list[index]->canParallelize()) {
+                    // Submit the modules without dependencies, the others are submitted by their last dependency
+                    if(dependency_count[index] == 0) {
+                        thread_pool->submit_module_function([&execute_module, index]() { execute_module(index); });
+                    }
+                } else {
+                    // Finish thread pool
+                    thread_pool->execute_all();
+                    // Execute current module
+                    execute_module(index);
+                }
             }
-        }
 
-        // Finish executing the last remaining tasks
-        thread_pool->execute_all();
+            // Finish executing the last remaining tasks
+            thread_pool->execute_all();
 
-        // Reset object count for next event
-        TProcessID::SetObjectCount(save_id);
+            // Reset object count for next event
+            TProcessID::SetObjectCount(save_id);
+        }
     }
     LOG_PROGRESS(STATUS, "EVENT_LOOP") << "Finished run of " << number_of_events << " events";
     auto end_time = std::chrono::steady_clock::now();
@@ -672,6 +774,202 @@ void ModuleManager::run() {
     assert(thread_pool.use_count() == 0);
 }
 
+/**
+ * Every event is processed by one of the event threads, which runs all modules in the linear order for that event. Messages
+ * are kept separate per event by delaying their delivery until the receiving module runs for that event. A module only runs
+ * an event after it finished the previous one, thus every module processes all events in order and receives the same data
+ * as in a sequential run. Modules that can be parallelized are executed in the event thread and can still submit their tasks
+ * to the thread pool. Modules that cannot be parallelized are handed over to the main thread, which only executes these
+ * modules, because they might depend on the thread local state of external libraries like Geant4.
+ *
+ * Objects of multiple events exist at the same time, thus the ROOT object count cannot be reset after every event. Instead,
+ * no new events are started once the count exceeds a limit, and the count is reset as soon as all running events are
+ * finished. The identifiers of referenced objects in the output therefore differ from a sequential run.
+ *
+ * @warning Messages should only be dispatched from the thread executing the run-method of a module
+ */
+unsigned int ModuleManager::run_concurrent_events(unsigned int number_of_events,
+                                                  unsigned int concurrent_events,
+                                                  const std::function<void()>& init_function) {
+    const unsigned int requested_events = number_of_events;
+    std::mutex event_mutex;
+    std::condition_variable event_condition;
+    unsigned int next_event = 1;
+    bool aborted = false;
+    std::exception_ptr exception_ptr{nullptr};
+
+    // Last event finished by every module
+    std::map<Module*, unsigned int> module_last_event;
+    for(auto& module : modules_) {
+        module_last_event[module.get()] = 0;
+    }
+
+    // Modules that cannot be parallelized, waiting to be executed by the main thread
+    std::deque<std::packaged_task<void()>> main_tasks;
+    std::condition_variable main_condition;
+    unsigned int active_threads = concurrent_events;
+
+    // Number of running events and object count to return to when no event is running, references can only store 24 bits
+    // of the object number thus the count is reset after using half of them
+    const UInt_t object_count_limit = 0x800000;
+    auto save_id = TProcessID::GetObjectCount();
+    unsigned int running_events = 0;
+    bool reset_object_count = false;
+
+    auto run_event = [&](unsigned int event_num) {
+        LOG_PROGRESS(STATUS, "EVENT_LOOP") << "Running event " << event_num << " of " << requested_events;
+
+        // Delay all messages dispatched by this thread until the receiver runs for this event
+        Messenger::DelayedMessages delayed_messages;
+        messenger_->set_delayed_messages(&delayed_messages);
+
+        for(auto& module : modules_) {
+            // Wait until the module finished the previous event
+            {
+                Tracer::Span span(tracer_.get(),
+                                  "wait",
+                                  (tracer_ != nullptr ? "Wait for " + module->getUniqueName() : std::string()),
+                                  event_num);
+                std::unique_lock<std::mutex> lock{event_mutex};
+                event_condition.wait(
+                    lock, [&]() { return aborted || module_last_event[module.get()] + 1 == event_num; });
+                if(aborted) {
+                    break;
+                }
+            }
+
+            // Hand over the messages of this event and run the module
+            if(module->canParallelize()) {
+                messenger_->deliver_delayed_messages(delayed_messages, module.get());
+                run_module(module.get(), event_num, requested_events);
+            } else {
+                // Let the main thread run the module, delaying the messages it dispatches in the same way
+                std::packaged_task<void()> task([&, module = module.get()]() {
+                    messenger_->set_delayed_messages(&delayed_messages);
+                    messenger_->deliver_delayed_messages(delayed_messages, module);
+                    run_module(module, event_num, requested_events);
+                });
+                auto result = task.get_future();
+                {
+                    std::lock_guard<std::mutex> lock{event_mutex};
+                    main_tasks.push_back(std::move(task));
+                }
+                main_condition.notify_one();
+
+                Tracer::Span span(tracer_.get(),
+                                  "wait",
+                                  (tracer_ != nullptr ? "Wait for main thread" : std::string()),
+                                  event_num);
+                result.get();
+            }
+
+            // Release the module for the next event
+            {
+                std::lock_guard<std::mutex> lock{event_mutex};
+                module_last_event[module.get()] = event_num;
+            }
+            event_condition.notify_all();
+        }
+
+        messenger_->set_delayed_messages(nullptr);
+    };
+
+    auto event_loop = [&]() {
+        while(true) {
+            // Fetch the next event to process, events are always started in order
+            unsigned int event_num;
+            {
+                std::unique_lock<std::mutex> lock{event_mutex};
+
+                // Wait for all running events to finish before resetting the object count
+                if(TProcessID::GetObjectCount() - save_id > object_count_limit) {
+                    reset_object_count = true;
+                }
+                event_condition.wait(lock, [&]() { return aborted || !reset_object_count || running_events == 0; });
+                if(reset_object_count && running_events == 0) {
+                    TProcessID::SetObjectCount(save_id);
+                    reset_object_count = false;
+                }
+
+                if(aborted || next_event > number_of_events) {
+                    break;
+                }
+                if(terminate_) {
+                    LOG(INFO) << "Interrupting event loop after " << (next_event - 1)
+                              << " events because of request to terminate";
+                    number_of_events = next_event - 1;
+                    break;
+                }
+                event_num = next_event++;
+                ++running_events;
+            }
+
+            try {
+                run_event(event_num);
+            } catch(...) {
+                messenger_->set_delayed_messages(nullptr);
+
+                // Save the first exception and stop all other events
+                std::lock_guard<std::mutex> lock{event_mutex};
+                if(!aborted) {
+                    exception_ptr = std::current_exception();
+                    aborted = true;
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock{event_mutex};
+                --running_events;
+            }
+            event_condition.notify_all();
+        }
+    };
+
+    // Start the event threads
+    std::vector<std::thread> event_threads;
+    for(unsigned int i = 1; i <= concurrent_events; ++i) {
+        event_threads.emplace_back([&, i]() {
+            init_function();
+            if(tracer_ != nullptr) {
+                tracer_->setThreadName("Event thread " + std::to_string(i));
+            }
+            event_loop();
+
+            std::lock_guard<std::mutex> lock{event_mutex};
+            --active_threads;
+            main_condition.notify_one();
+        });
+    }
+
+    // Execute the modules that cannot be parallelized in the main thread until all event threads are finished
+    while(true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock{event_mutex};
+            main_condition.wait(lock, [&]() { return !main_tasks.empty() || active_threads == 0; });
+            if(main_tasks.empty()) {
+                break;
+            }
+            task = std::move(main_tasks.front());
+            main_tasks.pop_front();
+        }
+        // Exceptions are passed to the event thread waiting for the module
+        task();
+        messenger_->set_delayed_messages(nullptr);
+    }
+    for(auto& thread : event_threads) {
+        thread.join();
+    }
+
+    // Propagate the first exception to the main thread
+    if(exception_ptr) {
+        Log::setSection("");
+        std::rethrow_exception(exception_ptr);
+    }
+
+    return number_of_events;
+}
+
 static std::string seconds_to_time(long double seconds) {
     auto duration = std::chrono::duration<long long>(static_cast<long long>(std::round(seconds)));
 
@@ -724,24 +1022,61 @@ void ModuleManager::finalize() {
         set_module_after(old_settings);
         // Update execution time
         auto end = std::chrono::steady_clock::now();
-        module_execution_time_[module.get()] += static_cast<std::chrono::duration<long double>>(end - start).count();
+        module_statistics_[module.get()].finalize_time =
+            static_cast<std::chrono::duration<long double>>(end - start).count();
+        if(tracer_ != nullptr) {
+            tracer_->record("finalize", module->getUniqueName(), 0, start, end);
+        }
     }
     LOG_PROGRESS(STATUS, "FINALIZE_LOOP") << "Finalization completed";
 
     long double slowest_time = 0;
     std::string slowest_module;
-    for(auto& module_time : module_execution_time_) {
-        if(module_time.second > slowest_time) {
-            slowest_time = module_time.second;
-            slowest_module = module_time.first->getUniqueName();
+    size_t name_width = 6;
+    for(auto& module : modules_) {
+        auto module_time = module_statistics_[module.get()].getTotalTime();
+        if(module_time > slowest_time) {
+            slowest_time = module_time;
+            slowest_module = module->getUniqueName();
         }
+        name_width = std::max(name_width, module->getUniqueName().size());
     }
     LOG(STATUS) << "Executed " << modules_.size() << " instantiations in " << seconds_to_time(total_time_) << ", spending "
                 << std::round((100 * slowest_time) / std::max(1.0l, total_time_)) << "% of time in slowest instantiation "
                 << slowest_module;
+
+    // Print a table with the event latencies of all modules in milliseconds
+    LOG(INFO) << std::left << std::setw(static_cast<int>(name_width)) << "Module" << std::right << std::setw(12)
+              << "total [s]" << std::setw(10) << "events" << std::setw(10) << "skipped" << std::setw(12) << "mean [ms]"
+              << std::setw(12) << "p50 [ms]" << std::setw(12) << "p95 [ms]" << std::setw(12) << "p99 [ms]"
+              << std::setw(12) << "max [ms]";
     for(auto& module : modules_) {
-        LOG(INFO) << " Module " << module->getUniqueName() << " took " << module_execution_time_[module.get()] << " seconds";
+        auto& statistics = module_statistics_[module.get()];
+        auto& latency = statistics.run_latency;
+        LOG(INFO) << std::left << std::setw(static_cast<int>(name_width)) << module->getUniqueName() << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(12) << statistics.getTotalTime() << std::setw(10)
+                  << latency.getCount() << std::setw(10) << statistics.skipped_events.load() << std::setw(12)
+                  << latency.getMean() * 1e3l << std::setw(12) << latency.getQuantile(0.50) * 1e3l << std::setw(12)
+                  << latency.getQuantile(0.95) * 1e3l << std::setw(12) << latency.getQuantile(0.99) * 1e3l
+                  << std::setw(12) << latency.getMaximum() * 1e3l;
+    }
+
+    // Write the timeline of the execution
+    if(tracer_ != nullptr) {
+        auto trace_file = std::string(gSystem->pwd()) + "/" + global_config_.get<std::string>("trace_file") + ".json";
+        if(tracer_->write(trace_file)) {
+            LOG(STATUS) << "Wrote execution trace to " << trace_file;
+        } else {
+            LOG(WARNING) << "Cannot write execution trace to " << trace_file;
+        }
     }
+
+    // Write the statistics in machine-readable format
+    auto statistics_file = global_config_.get<std::string>("statistics_file", "");
+    if(!statistics_file.empty()) {
+        write_statistics(std::string(gSystem->pwd()) + "/" + statistics_file + ".json");
+    }
+
     long double processing_time = 0;
     if(global_config_.get<unsigned int>("number_of_events") > 0) {
         processing_time = std::round((1000 * total_time_) / global_config_.get<unsigned int>("number_of_events"));
@@ -751,6 +1086,64 @@ void ModuleManager::finalize() {
                 << std::round(global_config_.get<double>("number_of_events") / total_time_) << " Hz\x1B[0m";
 }
 
+/**
+ * The file contains the number of events and the total run time, together with an entry per module instantiation holding
+ * the durations of all stages and the event latency quantiles. All times are given in seconds.
+ */
+void ModuleManager::write_statistics(const std::string& file_name) const {
+    std::ofstream file(file_name);
+    if(!file) {
+        LOG(WARNING) << "Cannot write module statistics to " << file_name;
+        return;
+    }
+
+    // Escape the characters which are not allowed in JSON strings
+    auto quote = [](const std::string& str) {
+        std::string quoted = "\"";
+        for(auto chr : str) {
+            if(chr == '"' || chr == '\\') {
+                quoted += '\\';
+            }
+            quoted += chr;
+        }
+        return quoted + "\"";
+    };
+
+    file << std::setprecision(9);
+    file << "{\n";
+    file << "  \"number_of_events\": " << global_config_.get<unsigned int>("number_of_events") << ",\n";
+    file << "  \"total_time\": " << total_time_ << ",\n";
+    file << "  \"modules\": [";
+    bool first = true;
+    for(auto& module : modules_) {
+        auto& statistics = module_statistics_.at(module.get());
+        auto& latency = statistics.run_latency;
+        file << (first ? "\n" : ",\n");
+        first = false;
+
+        file << "    {\n";
+        file << "      \"name\": " << quote(module->getUniqueName()) << ",\n";
+        file << "      \"construction_time\": " << statistics.construction_time << ",\n";
+        file << "      \"init_time\": " << statistics.init_time << ",\n";
+        file << "      \"run_time\": " << latency.getTotal() << ",\n";
+        file << "      \"finalize_time\": " << statistics.finalize_time << ",\n";
+        file << "      \"events\": " << latency.getCount() << ",\n";
+        file << "      \"skipped_events\": " << statistics.skipped_events.load() << ",\n";
+        file << "      \"latency\": {\n";
+        file << "        \"mean\": " << latency.getMean() << ",\n";
+        file << "        \"p50\": " << latency.getQuantile(0.50) << ",\n";
+        file << "        \"p95\": " << latency.getQuantile(0.95) << ",\n";
+        file << "        \"p99\": " << latency.getQuantile(0.99) << ",\n";
+        file << "        \"max\": " << latency.getMaximum() << "\n";
+        file << "      }\n";
+        file << "    }";
+    }
+    file << "\n  ]\n";
+    file << "}\n";
+
+    LOG(DEBUG) << "Wrote module statistics to " << file_name;
+}
+
 /**
  * All modules in the event loop continue to finish the current event
  */
@@ -11,6 +11,7 @@
 #define ALLPIX_MODULE_MANAGER_H
 
 #include <atomic>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -21,8 +22,11 @@
 #include <TFile.h>
 
 #include "Module.hpp"
+#include "ModuleStatistics.hpp"
 #include "ThreadPool.hpp"
+#include "Tracer.hpp"
 #include "core/config/Configuration.hpp"
+#include "core/messenger/BufferPool.hpp"
 #include "core/utils/log.h"
 
 namespace allpix {
@@ -135,6 +139,25 @@ namespace allpix {
          */
         void set_module_after(std::tuple<LogLevel, LogFormat> prev);
 
+        /**
+         * @brief Run a single module for an event
+         * @param module Module to execute
+         * @param event_num Number of the event to run
+         * @param number_of_events Total number of events (used for logging only)
+         */
+        void run_module(Module* module, unsigned int event_num, unsigned int number_of_events);
+
+        /**
+         * @brief Run the event sequence with multiple events in flight at the same time
+         * @param number_of_events Number of events to process
+         * @param concurrent_events Number of events to process concurrently
+         * @param init_function Function to initialize the thread local variables of the event threads
+         * @return Number of events actually processed (less than requested if termination was requested)
+         */
+        unsigned int run_concurrent_events(unsigned int number_of_events,
+                                           unsigned int concurrent_events,
+                                           const std::function<void()>& init_function);
+
         using ModuleList = std::list<std::unique_ptr<Module>>;
         using IdentifierToModuleMap = std::map<ModuleIdentifier, ModuleList::iterator>;
 
@@ -143,11 +166,23 @@ namespace allpix {
 
         std::unique_ptr<TFile> modules_file_;
 
-        std::map<Module*, long double> module_execution_time_;
+        /**
+         * @brief Write the execution statistics of all modules to a JSON file
+         * @param file_name Path of the file to write to
+         */
+        void write_statistics(const std::string& file_name) const;
+
+        std::map<Module*, ModuleStatistics> module_statistics_;
         long double total_time_{};
 
+        std::unique_ptr<Tracer> tracer_;
+
+        BufferPool buffer_pool_;
+
         Configuration global_config_;
 
+        Messenger* messenger_{nullptr};
+
         std::map<std::string, void*> loaded_libraries_;
 
         std::atomic<bool> terminate_;
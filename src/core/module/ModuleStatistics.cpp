@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @brief Implementation of the execution statistics collected for every module instantiation
+ *
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "ModuleStatistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace allpix;
+
+constexpr uint64_t LatencyHistogram::sub_buckets;
+constexpr size_t LatencyHistogram::bucket_count;
+
+/**
+ * Latencies below twice the number of sub buckets get their own bucket. Larger latencies are shifted until only the leading
+ * bit and the bits selecting the sub bucket remain, each shift moving to the next power of two.
+ */
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    uint64_t shift = 0;
+    while((value >> shift) >= 2 * sub_buckets) {
+        ++shift;
+    }
+    return shift * sub_buckets + (value >> shift);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration) {
+    auto value = static_cast<uint64_t>(std::max(duration.count(), static_cast<std::chrono::nanoseconds::rep>(0)));
+
+    buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(value, std::memory_order_relaxed);
+
+    // Update the maximum unless another thread recorded a larger value in the meantime
+    auto maximum = maximum_.load(std::memory_order_relaxed);
+    while(value > maximum && !maximum_.compare_exchange_weak(maximum, value, std::memory_order_relaxed)) {
+    }
+}
+
+long double LatencyHistogram::getTotal() const {
+    return static_cast<long double>(total_.load(std::memory_order_relaxed)) * 1e-9l;
+}
+
+long double LatencyHistogram::getMean() const {
+    auto count = getCount();
+    if(count == 0) {
+        return 0;
+    }
+    return getTotal() / static_cast<long double>(count);
+}
+
+long double LatencyHistogram::getMaximum() const {
+    return static_cast<long double>(maximum_.load(std::memory_order_relaxed)) * 1e-9l;
+}
+
+/**
+ * The quantile is returned as the center of the bucket holding the entry with the requested rank, but never exceeds the
+ * largest recorded latency.
+ */
+long double LatencyHistogram::getQuantile(double quantile) const {
+    auto count = getCount();
+    if(count == 0) {
+        return 0;
+    }
+
+    // Find the rank of the requested entry, starting from one
+    auto rank = static_cast<uint64_t>(std::ceil(std::min(std::max(quantile, 0.0), 1.0) * static_cast<double>(count)));
+    rank = std::max(rank, static_cast<uint64_t>(1));
+
+    uint64_t cumulative = 0;
+    for(size_t index = 0; index < bucket_count; ++index) {
+        cumulative += buckets_[index].load(std::memory_order_relaxed);
+        if(cumulative < rank) {
+            continue;
+        }
+
+        // Compute the center of the bucket from its index
+        long double center = 0;
+        if(index < 2 * sub_buckets) {
+            center = static_cast<long double>(index) + 0.5l;
+        } else {
+            auto shift = static_cast<int>(index / sub_buckets) - 1;
+            auto leading = static_cast<long double>(index - static_cast<size_t>(shift) * sub_buckets);
+            center = std::ldexp(leading + 0.5l, shift);
+        }
+        return std::min(center * 1e-9l, getMaximum());
+    }
+    return getMaximum();
+}
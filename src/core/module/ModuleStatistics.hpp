@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @brief Definition of the execution statistics collected for every module instantiation
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_MODULE_STATISTICS_H
+#define ALLPIX_MODULE_STATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace allpix {
+
+    /**
+     * @brief Histogram of execution latencies which can be filled concurrently
+     *
+     * Latencies are counted in nanoseconds in logarithmic buckets: every power of two is split into \ref sub_buckets linear
+     * buckets, which bounds the relative error of the reported quantiles to the inverse of the number of sub buckets, while
+     * covering the full range of a 64-bit counter. All counters are atomic and are only updated with relaxed ordering, such
+     * that recording a latency does not require a lock. The histogram should only be read when no thread records to it.
+     */
+    class LatencyHistogram {
+    public:
+        /**
+         * @brief Record a single latency
+         * @param duration Measured duration
+         */
+        void record(std::chrono::nanoseconds duration);
+
+        /**
+         * @brief Get the number of recorded latencies
+         * @return Number of entries in the histogram
+         */
+        uint64_t getCount() const { return count_.load(std::memory_order_relaxed); }
+        /**
+         * @brief Get the sum of all recorded latencies
+         * @return Total time in seconds
+         */
+        long double getTotal() const;
+        /**
+         * @brief Get the mean of the recorded latencies
+         * @return Mean latency in seconds (zero if the histogram is empty)
+         */
+        long double getMean() const;
+        /**
+         * @brief Get the largest recorded latency
+         * @return Maximum latency in seconds
+         */
+        long double getMaximum() const;
+        /**
+         * @brief Estimate a quantile of the recorded latencies
+         * @param quantile Requested quantile between zero and one
+         * @return Center of the bucket containing the quantile in seconds (zero if the histogram is empty)
+         */
+        long double getQuantile(double quantile) const;
+
+        /**
+         * @brief Number of linear buckets per power of two
+         */
+        static constexpr uint64_t sub_buckets = 16;
+
+    private:
+        /**
+         * @brief Get the bucket a latency belongs to
+         * @param value Latency in nanoseconds
+         * @return Index of the bucket
+         */
+        static size_t bucket_index(uint64_t value);
+
+        // Buckets for all latencies up to the maximum value of a 64-bit counter
+        static constexpr size_t bucket_count = 61 * sub_buckets;
+
+        std::array<std::atomic<uint64_t>, bucket_count> buckets_{};
+        std::atomic<uint64_t> count_{};
+        std::atomic<uint64_t> total_{};
+        std::atomic<uint64_t> maximum_{};
+    };
+
+    /**
+     * @brief Execution statistics of a single module instantiation
+     *
+     * The durations of the construction, initialization and finalization are only written by the main thread. The event
+     * latencies and counters can be updated concurrently by all threads running the module.
+     */
+    struct ModuleStatistics {
+        long double construction_time{};
+        long double init_time{};
+        long double finalize_time{};
+
+        LatencyHistogram run_latency;
+        std::atomic<uint64_t> skipped_events{};
+
+        /**
+         * @brief Get the total time spent in the module
+         * @return Sum of the time spent in all stages in seconds
+         */
+        long double getTotalTime() const {
+            return construction_time + init_time + run_latency.getTotal() + finalize_time;
+        }
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_MODULE_STATISTICS_H */
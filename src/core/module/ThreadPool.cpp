@@ -13,35 +13,107 @@ using namespace allpix;
 /**
  * The threads are created in an exception-safe way and all will be destroyed when creating them fails
  */
-ThreadPool::ThreadPool(unsigned int num_threads, std::vector<Module*> modules, std::function<void()> worker_init_function) {
+ThreadPool::ThreadPool(unsigned int num_threads,
+                       std::vector<Module*> modules,
+                       std::function<void()> worker_init_function,
+                       Tracer* tracer)
+    : tracer_(tracer) {
+    has_exception_.clear();
+
+    // Add module queues before starting the threads that steal from them
+    all_queues_.push_back(&module_queue_);
+    for(auto& module : modules) {
+        auto queue = std::make_unique<WorkStealingQueue<Task>>();
+        all_queues_.push_back(queue.get());
+        task_queues_.emplace(module, std::move(queue));
+        if(tracer_ != nullptr) {
+            task_names_.emplace(module, module->getUniqueName());
+        }
+    }
+
     // Create threads
     try {
         for(unsigned int i = 0u; i < num_threads; ++i) {
-            threads_.emplace_back(&ThreadPool::worker, this, worker_init_function);
+            threads_.emplace_back(&ThreadPool::worker, this, i + 1, worker_init_function);
         }
     } catch(...) {
         destroy();
         throw;
     }
-
-    // Add module module queues
-    for(auto& module : modules) {
-        // Default constructs a queue for all modules
-        // NOTE: this is the only valid method due to SafeTask not being movable
-        task_queues_[module];
-    }
-    run_cnt_ = 0;
 }
 
-void ThreadPool::submit_module_function(std::function<void()> module_function) {
-    module_queue_.push(std::make_unique<std::packaged_task<void()>>(std::move(module_function)));
-    all_queue_.push(&module_queue_);
+/**
+ * Functions submitted by a thread running a module are pushed to the queue of that module, because only the owner can push
+ * to a work-stealing queue. The pool executes them like any other task of the module.
+ */
+void ThreadPool::submit_module_function(std::function<void()> module_function, Module* source) {
+    auto& queue = (source == nullptr ? module_queue_ : *task_queues_.at(source));
+    push_task(queue, new std::packaged_task<void()>(std::move(module_function)));
 }
 
 ThreadPool::~ThreadPool() {
     destroy();
 }
 
+/**
+ * The counters are increased before the task becomes visible, such that a thief never observes a task that is not counted.
+ * Sleeping threads are only notified if there are any, to keep submitting lock-free when all workers are busy.
+ */
+void ThreadPool::push_task(WorkStealingQueue<Task>& queue, Task task) {
+    ++pending_cnt_;
+    ++queued_cnt_;
+    queue.push(task);
+
+    if(sleeping_cnt_ > 0) {
+        std::lock_guard<std::mutex> lock{wait_mutex_};
+        wait_condition_.notify_one();
+    }
+}
+
+/**
+ * Queues are visited round-robin starting from the given index, to distribute the thieves over the different queues
+ */
+bool ThreadPool::steal_task(Task& task, size_t start) {
+    for(size_t i = 0; i < all_queues_.size(); ++i) {
+        if(all_queues_[(start + i) % all_queues_.size()]->steal(task)) {
+            --queued_cnt_;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * If the pool is invalidated the task is destroyed without running it, which breaks the promise of its future and thus
+ * releases any module waiting for the result. Only the first exception thrown is kept to propagate to the main thread.
+ */
+void ThreadPool::run_task(Task task) {
+    std::unique_ptr<std::packaged_task<void()>> task_ptr(task);
+    if(valid_) {
+        try {
+            // Execute task
+            (*task_ptr)();
+            // Fetch the future to propagate exceptions
+            task_ptr->get_future().get();
+        } catch(...) {
+            // Check if the first exception thrown
+            if(!has_exception_.test_and_set()) {
+                // Save first exception
+                exception_ptr_ = std::current_exception();
+                // Invalidate the pool to terminate other threads
+                valid_ = false;
+            }
+        }
+    }
+    task_ptr.reset();
+
+    // Propagate that the task has been finished
+    if(--pending_cnt_ == 0) {
+        std::lock_guard<std::mutex> lock{wait_mutex_};
+        wait_condition_.notify_all();
+    }
+}
+
 /**
  * @warning This function does not wait for the all the running tasks to finish
  * @warning The module running this function is responsible for handling exceptions in the function called
@@ -51,51 +123,56 @@ ThreadPool::~ThreadPool() {
  */
 bool ThreadPool::execute(Module* module) {
     // Run tasks until the queue is empty
+    auto& queue = *task_queues_.at(module);
     Task task{nullptr};
-    while(task_queues_.at(module).pop(task, false)) {
-        // Execute task
-        (*task)();
+    while(queue.pop(task)) {
+        --queued_cnt_;
+        std::unique_ptr<std::packaged_task<void()>> task_ptr(task);
+        if(valid_) {
+            // Execute task
+            (*task_ptr)();
+        }
+        auto future = task_ptr->get_future();
+        task_ptr.reset();
+
+        // Propagate that the task has been finished
+        if(--pending_cnt_ == 0) {
+            std::lock_guard<std::mutex> lock{wait_mutex_};
+            wait_condition_.notify_all();
+        }
+
         // Fetch the future to propagate exceptions
-        task->get_future().get();
+        future.get();
     }
-    return task_queues_.at(module).isValid();
+    return valid_;
 }
 
 /**
  * Run by the \ref ModuleManager to ensure all tasks and modules are completed before moving to the next instantiations.
- * Besides waiting for the queue to empty this will also wait for all the tasks to be completed. If an exception is
+ * Besides waiting for the queues to empty this will also wait for all the tasks to be completed. If an exception is
  * thrown by another thread, the exception will be propagated to the main thread by this function.
+ *
+ * The module functions are taken from the top of the queue of the module manager like the workers do, such that they are
+ * run in the order they have been submitted.
  */
 bool ThreadPool::execute_all() {
     while(true) {
-        // Run tasks until the queue is empty
-        SafeQueue<Task>* queue_ptr;
-        while(all_queue_.pop(queue_ptr, false)) {
-            Task task{nullptr};
-            if(queue_ptr->pop(task, false)) {
-                try {
-                    // Execute task
-                    (*task)();
-                    // Fetch the future to propagate exceptions
-                    task->get_future().get();
-                } catch(...) {
-                    // Check if the first exception thrown
-                    if(has_exception_.test_and_set()) {
-                        // Check if the first exception thrown
-                        exception_ptr_ = std::current_exception();
-                        // Invalidate the queue to terminate other threads
-                        all_queue_.invalidate();
-                    }
-                }
-            }
+        // Run the module functions first and help the workers with the tasks of the modules afterwards
+        Task task{nullptr};
+        if(steal_task(task, 0)) {
+            run_task(task);
+            continue;
         }
 
         // Wait for the threads to complete their task, continue helping if a new task was pushed
-        std::unique_lock<std::mutex> lock{run_mutex_};
-        run_condition_.wait(lock, [this]() { return !all_queue_.empty() || run_cnt_ == 0; });
-
-        // Only stop when both the queue is empty and the run count is zero
-        if(all_queue_.empty() && run_cnt_ == 0) {
+        Tracer::Span span(tracer_, "wait", "Wait for tasks");
+        std::unique_lock<std::mutex> lock{wait_mutex_};
+        ++sleeping_cnt_;
+        wait_condition_.wait(lock, [this]() { return pending_cnt_ == 0 || queued_cnt_ > 0; });
+        --sleeping_cnt_;
+
+        // Only stop when all tasks are finished
+        if(pending_cnt_ == 0) {
             break;
         }
     }
@@ -107,57 +184,43 @@ bool ThreadPool::execute_all() {
         std::rethrow_exception(exception_ptr_);
     }
 
-    return all_queue_.isValid();
+    return valid_;
 }
 
 /**
- * If an exception is thrown by a module, the first exception is saved to propagate in the main thread
+ * Workers steal tasks from all queues and sleep when there are no queued tasks left
  */
-void ThreadPool::worker(const std::function<void()>& init_function) {
+void ThreadPool::worker(unsigned int index, const std::function<void()>& init_function) {
     // Initialize the worker
     init_function();
-
-    // Safe lambda to increase the atomic run count
-    auto increase_run_cnt_func = [this]() { ++run_cnt_; };
+    if(tracer_ != nullptr) {
+        tracer_->setThreadName("Worker " + std::to_string(index));
+    }
 
     // Continue running until the thread pool is finished
     while(!done_) {
-        SafeQueue<Task>* queue_ptr;
-        if(all_queue_.pop(queue_ptr, true, increase_run_cnt_func)) {
-            Task task{nullptr};
-            if(queue_ptr->pop(task, false)) {
-                // Try to run task
-                try {
-                    // Execute task
-                    (*task)();
-                    // Fetch the future to propagate exceptions
-                    task->get_future().get();
-                } catch(...) {
-                    // Check if the first exception thrown
-                    if(has_exception_.test_and_set()) {
-                        // Save first exception
-                        exception_ptr_ = std::current_exception();
-                        // Invalidate the queue to terminate other threads
-                        all_queue_.invalidate();
-                    }
-                }
-            }
-
-            // Propagate that the task has been finished
-            std::lock_guard<std::mutex> lock{run_mutex_};
-            --run_cnt_;
-            run_condition_.notify_all();
+        Task task{nullptr};
+        if(steal_task(task, index)) {
+            run_task(task);
+            continue;
         }
+
+        // Sleep until new tasks are queued
+        Tracer::Span span(tracer_, "wait", "Idle");
+        std::unique_lock<std::mutex> lock{wait_mutex_};
+        ++sleeping_cnt_;
+        wait_condition_.wait(lock, [this]() { return done_ || queued_cnt_ > 0; });
+        --sleeping_cnt_;
     }
 }
 
 void ThreadPool::destroy() {
     done_ = true;
+    valid_ = false;
 
-    all_queue_.invalidate();
-    module_queue_.invalidate();
-    for(auto& queue : task_queues_) {
-        queue.second.invalidate();
+    {
+        std::lock_guard<std::mutex> lock{wait_mutex_};
+        wait_condition_.notify_all();
     }
 
     for(auto& thread : threads_) {
@@ -165,4 +228,14 @@ void ThreadPool::destroy() {
             thread.join();
         }
     }
+
+    // Delete all tasks that never started
+    for(auto& queue : all_queues_) {
+        Task task{nullptr};
+        while(queue->pop(task)) {
+            --queued_cnt_;
+            --pending_cnt_;
+            delete task;
+        }
+    }
 }
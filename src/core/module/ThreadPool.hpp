@@ -9,13 +9,14 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <exception>
 #include <functional>
 #include <future>
 #include <map>
 #include <memory>
-#include <queue>
+#include <mutex>
 #include <thread>
 #include <type_traits>
 #include <utility>
@@ -23,68 +24,102 @@
 
 #include <iostream>
 
+#include "Tracer.hpp"
+
 namespace allpix {
     class Module;
 
     /**
      * @brief Pool of threads where module tasks can be submitted to
+     *
+     * Every module instantiation and the module manager own a separate work-stealing queue. The owner pushes and pops tasks
+     * without locking, while idle worker threads steal tasks from the other end of any queue.
      */
     class ThreadPool {
         friend class ModuleManager;
 
     private:
         /**
-         * @brief Internal thread-safe queue
+         * @brief Internal work-stealing deque
+         *
+         * Lock-free double-ended queue where a single owner pushes and pops at the bottom, while any other thread can steal
+         * from the top. Implements the algorithm of Chase and Lev as adapted for weak memory models by Le et al.
          */
-        template <typename T> class SafeQueue {
+        template <typename T> class WorkStealingQueue {
         public:
             /**
-             * @brief Default constructor, initializes empty queue
+             * @brief Construct empty queue with an initial capacity
+             * @param capacity Initial capacity (should be a power of two)
              */
-            SafeQueue() = default;
+            explicit WorkStealingQueue(int64_t capacity = 64);
 
+            /// @{
             /**
-             * @brief Erases the queue and release waiting threads on destruction
+             * @brief Copying or moving the queue is not allowed
              */
-            ~SafeQueue();
+            WorkStealingQueue(const WorkStealingQueue&) = delete;
+            WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+            WorkStealingQueue(WorkStealingQueue&&) = delete;
+            WorkStealingQueue& operator=(WorkStealingQueue&&) = delete;
+            /// @}
 
             /**
-             * @brief Get the top value in the safe queue
-             * @param out Reference where the value at the top of the queue will be written to
-             * @param wait If the method should wait for new tasks or should exit (defaults to wait)
-             * @param func Optional function to execute before releasing the queue mutex if pop was successful
-             * @return True if a task was acquired or false if pop was exited for another reason
+             * @brief Default destructor (does not destroy the stored values)
              */
-            bool pop(T& out, bool wait = true, const std::function<void()>& func = nullptr);
+            ~WorkStealingQueue() = default;
 
             /**
-             * @brief Push a new value onto the safe queue
+             * @brief Push a new value at the bottom of the queue
              * @param value Value to push to the queue
+             * @warning Should only be called by the owner of the queue
              */
             void push(T value);
 
             /**
-             * @brief Return if the queue is in a valid state
-             * @return True if the queue is valid, false if \ref TaskQueue::invalidate was called
+             * @brief Pop the most recently pushed value from the bottom of the queue
+             * @param out Reference where the value will be written to
+             * @return True if a value was acquired, false if the queue was empty
+             * @warning Should only be called by the owner of the queue
              */
-            bool isValid() const;
+            bool pop(T& out);
+
+            /**
+             * @brief Steal the least recently pushed value from the top of the queue
+             * @param out Reference where the value will be written to
+             * @return True if a value was acquired, false if the queue was empty or another thread won the race
+             */
+            bool steal(T& out);
 
             /**
              * @brief Return if the queue is empty or not
              * @return True if the queue is empty, false otherwise
+             * @note The result is only a snapshot if other threads are accessing the queue
              */
             bool empty() const;
 
+        private:
             /**
-             * @brief Invalidate the queue
+             * @brief Circular buffer storing the values of the queue
              */
-            void invalidate();
-
-        private:
-            std::atomic_bool valid_{true};
-            mutable std::mutex mutex_;
-            std::queue<T> queue_;
-            std::condition_variable condition_;
+            class Buffer {
+            public:
+                explicit Buffer(int64_t capacity);
+                int64_t capacity() const;
+                T get(int64_t index) const;
+                void put(int64_t index, T value);
+                Buffer* grow(int64_t bottom, int64_t top) const;
+
+            private:
+                int64_t capacity_;
+                std::unique_ptr<std::atomic<T>[]> values_;
+            };
+
+            std::atomic<int64_t> top_;
+            std::atomic<int64_t> bottom_;
+            std::atomic<Buffer*> buffer_;
+
+            // Buffers are only released on destruction, because thieves can still be reading from them
+            std::vector<std::unique_ptr<Buffer>> buffers_;
         };
 
     public:
@@ -93,11 +128,13 @@ namespace allpix {
          * @param num_thread Number of threads in the pool
          * @param modules List of module instantiations to create a task queue for
          * @param worker_init_function Function run by all the workers to initialize
+         * @param tracer Tracer to record the tasks and the waits of the threads in (or nullptr to disable tracing)
          * @warning Only module instantiations that are registered in this constructor can spawn tasks
          */
         explicit ThreadPool(unsigned int num_threads,
                             std::vector<Module*> modules,
-                            std::function<void()> worker_init_function);
+                            std::function<void()> worker_init_function,
+                            Tracer* tracer = nullptr);
 
         /// @{
         /**
@@ -119,13 +156,15 @@ namespace allpix {
          * @param args Parameters to pass to the function
          * @warning The thread submitting task should always call the \ref ThreadPool::execute method to prevent a lock when
          *          there are no threads available
+         * @warning Tasks for a module should only be submitted by the thread running that module
          */
         template <typename Func, typename... Args> auto submit(Module* module, Func&& func, Args&&... args);
 
         /**
-         * @brief Execute jobs from the module queue until all module tasks are finished or an interrupt happened
+         * @brief Execute jobs from the module queue until the queue is empty or an interrupt happened
          * @param module Module to run tasks for
          * @return True if module task queue finished, false if stopped for other reason
+         * @note Tasks stolen by other threads can still be running when this method returns
          */
         bool execute(Module* module);
 
@@ -133,9 +172,11 @@ namespace allpix {
         /**
          * @brief Function to run a single event for a module by the \ref ModuleManager
          * @param module_function Function to execute (should call the run-method of the module)
+         * @param source Module whose queue the function is added to (or nullptr to use the queue of the module manager)
          * @warning This method can only be called by the \ref ModuleManager
+         * @warning A source module should only be given by the thread that has been running that module
          */
-        void submit_module_function(std::function<void()> module_function);
+        void submit_module_function(std::function<void()> module_function, Module* source = nullptr);
 
         /**
          * @brief Execute jobs from the queue until all tasks and modules are finished or an interrupt happened
@@ -145,31 +186,62 @@ namespace allpix {
         bool execute_all();
 
         /**
-         * @brief Constantly running internal function each thread uses to acquire work items from the queue.
+         * @brief Constantly running internal function each thread uses to steal work items from the queues.
+         * @param index Index of the worker thread
          * @param init_function Function to initialize the relevant thread_local variables
          */
-        void worker(const std::function<void()>& init_function);
+        void worker(unsigned int index, const std::function<void()>& init_function);
+
+        using Task = std::packaged_task<void()>*;
+
+        /**
+         * @brief Push a task to the queue owned by the calling thread and wake up a sleeping worker
+         * @param queue Queue to add the task to
+         * @param task Task to add
+         */
+        void push_task(WorkStealingQueue<Task>& queue, Task task);
+
+        /**
+         * @brief Try to steal a task from any of the queues
+         * @param task Reference where the stolen task will be written to
+         * @param start Index of the queue to start stealing from
+         * @return True if a task has been stolen, false otherwise
+         */
+        bool steal_task(Task& task, size_t start);
+
+        /**
+         * @brief Run a task and propagate the first exception to the thread pool
+         * @param task Task to execute (deleted afterwards)
+         */
+        void run_task(Task task);
 
         /**
          * @brief Invalidate all queues and joins all running threads when the pool is destroyed.
          */
         void destroy();
 
-        using Task = std::unique_ptr<std::packaged_task<void()>>;
-
         std::atomic_bool done_{false};
+        std::atomic_bool valid_{true};
 
-        SafeQueue<SafeQueue<Task>*> all_queue_;
-        SafeQueue<Task> module_queue_;
-        std::map<Module*, SafeQueue<Task>> task_queues_;
+        WorkStealingQueue<Task> module_queue_;
+        std::map<Module*, std::unique_ptr<WorkStealingQueue<Task>>> task_queues_;
+        std::vector<WorkStealingQueue<Task>*> all_queues_;
 
-        std::atomic<unsigned int> run_cnt_;
-        mutable std::mutex run_mutex_;
-        std::condition_variable run_condition_;
+        // Number of tasks waiting in a queue and number of tasks not yet finished
+        std::atomic<unsigned int> queued_cnt_{0};
+        std::atomic<unsigned int> pending_cnt_{0};
+
+        std::atomic<unsigned int> sleeping_cnt_{0};
+        mutable std::mutex wait_mutex_;
+        std::condition_variable wait_condition_;
         std::vector<std::thread> threads_;
 
         std::atomic_flag has_exception_;
         std::exception_ptr exception_ptr_{nullptr};
+
+        // Tracer and the names of the traced tasks of every module
+        Tracer* tracer_;
+        std::map<Module*, std::string> task_names_;
     };
 }
 
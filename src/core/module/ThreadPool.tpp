@@ -7,64 +7,123 @@ namespace allpix {
         using PackagedTask = std::packaged_task<decltype(bound_task())()>;
         PackagedTask task(bound_task);
 
-        // Get future and wrapper to add to vector
+        // Get future and wrapper to add to the queue of the module
         auto future = task.get_future();
-        auto task_function = [task = std::move(task)]() mutable { task(); };
-        task_queues_.at(module).push(std::make_unique<std::packaged_task<void()>>(std::move(task_function)));
-        all_queue_.push(&task_queues_.at(module));
+        if(tracer_ == nullptr) {
+            auto task_function = [task = std::move(task)]() mutable { task(); };
+            push_task(*task_queues_.at(module), new std::packaged_task<void()>(std::move(task_function)));
+        } else {
+            // Record the task as part of the event the submitting module is running for
+            auto task_function = [ task = std::move(task),
+                                   tracer = tracer_,
+                                   name = task_names_.at(module),
+                                   event = Tracer::getCurrentEvent() ]() mutable {
+                Tracer::Span span(tracer, "task", name, event);
+                task();
+            };
+            push_task(*task_queues_.at(module), new std::packaged_task<void()>(std::move(task_function)));
+        }
         return future;
     }
 
-    template <typename T> ThreadPool::SafeQueue<T>::~SafeQueue() { invalidate(); }
+    template <typename T>
+    ThreadPool::WorkStealingQueue<T>::WorkStealingQueue(int64_t capacity) : top_(0), bottom_(0) {
+        buffers_.emplace_back(std::make_unique<Buffer>(capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
 
     /*
-    * Block until a value is available if the wait parameter is set to true. The wait exits when the queue is invalidated.
-    */
-    template <typename T> bool ThreadPool::SafeQueue<T>::pop(T& out, bool wait, const std::function<void()>& func) {
-        // Lock the mutex
-        std::unique_lock<std::mutex> lock{mutex_};
-        if(wait) {
-            // Wait for new item in the queue (unlocks the mutex while waiting)
-            condition_.wait(lock, [this]() { return !queue_.empty() || !valid_; });
+     * The buffer is doubled in size if it is full. The old buffer is kept alive, because thieves might still read from it.
+     */
+    template <typename T> void ThreadPool::WorkStealingQueue<T>::push(T value) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+
+        // Grow the buffer if it is full
+        if(bottom - top > buffer->capacity() - 1) {
+            buffers_.emplace_back(buffer->grow(bottom, top));
+            buffer = buffers_.back().get();
+            buffer_.store(buffer, std::memory_order_release);
         }
-        // Check for empty and valid queue
-        if(queue_.empty() || !valid_) {
+
+        buffer->put(bottom, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /*
+     * Only races with thieves if a single element is left in the queue, which is resolved by a compare-and-swap on the top.
+     */
+    template <typename T> bool ThreadPool::WorkStealingQueue<T>::pop(T& out) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        // Restore the bottom if the queue was empty
+        if(top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
             return false;
         }
 
-        // Pop the queue and optionally execute the mutex protected function
-        out = std::move(queue_.front());
-        queue_.pop();
-        if(func != nullptr) {
-            func();
+        out = buffer->get(bottom);
+        if(top == bottom) {
+            // Last element in the queue, race against thieves
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
         }
         return true;
     }
 
-    template <typename T> void ThreadPool::SafeQueue<T>::push(T value) {
-        std::lock_guard<std::mutex> lock{mutex_};
-        queue_.push(std::move(value));
-        condition_.notify_one();
+    template <typename T> bool ThreadPool::WorkStealingQueue<T>::steal(T& out) {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if(top >= bottom) {
+            return false;
+        }
+
+        // Read the value before claiming it, the claim fails if the owner or another thief was faster
+        Buffer* buffer = buffer_.load(std::memory_order_acquire);
+        T value = buffer->get(top);
+        if(!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    template <typename T> bool ThreadPool::WorkStealingQueue<T>::empty() const {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom <= top;
     }
 
-    template <typename T> bool ThreadPool::SafeQueue<T>::isValid() const {
-        std::lock_guard<std::mutex> lock{mutex_};
-        return valid_;
+    template <typename T>
+    ThreadPool::WorkStealingQueue<T>::Buffer::Buffer(int64_t capacity)
+        : capacity_(capacity), values_(std::make_unique<std::atomic<T>[]>(static_cast<size_t>(capacity))) {}
+
+    template <typename T> int64_t ThreadPool::WorkStealingQueue<T>::Buffer::capacity() const { return capacity_; }
+
+    template <typename T> T ThreadPool::WorkStealingQueue<T>::Buffer::get(int64_t index) const {
+        return values_[static_cast<size_t>(index & (capacity_ - 1))].load(std::memory_order_relaxed);
     }
 
-    template <typename T> bool ThreadPool::SafeQueue<T>::empty() const {
-        std::lock_guard<std::mutex> lock{mutex_};
-        return !valid_ || queue_.empty();
+    template <typename T> void ThreadPool::WorkStealingQueue<T>::Buffer::put(int64_t index, T value) {
+        values_[static_cast<size_t>(index & (capacity_ - 1))].store(value, std::memory_order_relaxed);
     }
 
-    /*
-     * Used to ensure no conditions are being waited for in pop when a thread or the application is trying to exit. The queue
-     * is invalid after calling this method and it is an error to continue using a queue after this method has been called.
-    */
-    template <typename T> void ThreadPool::SafeQueue<T>::invalidate() {
-        std::lock_guard<std::mutex> lock{mutex_};
-        std::queue<T>().swap(queue_);
-        valid_ = false;
-        condition_.notify_all();
+    template <typename T>
+    typename ThreadPool::WorkStealingQueue<T>::Buffer* ThreadPool::WorkStealingQueue<T>::Buffer::grow(int64_t bottom,
+                                                                                                      int64_t top) const {
+        auto buffer = new Buffer(2 * capacity_);
+        for(int64_t i = top; i < bottom; ++i) {
+            buffer->put(i, get(i));
+        }
+        return buffer;
     }
 }
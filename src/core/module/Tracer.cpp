@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief Implementation of the tracer recording a timeline of the module execution
+ *
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "Tracer.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <utility>
+
+using namespace allpix;
+
+std::atomic<uint64_t> Tracer::next_id_{1};
+
+namespace {
+    // Event of the innermost span running on this thread
+    thread_local unsigned int current_event = 0;
+
+    // Quote a string and escape the characters which are not allowed in JSON strings
+    std::string quote(const std::string& str) {
+        std::string quoted = "\"";
+        for(auto chr : str) {
+            if(chr == '"' || chr == '\\') {
+                quoted += '\\';
+            }
+            quoted += chr;
+        }
+        return quoted + "\"";
+    }
+} // namespace
+
+/**
+ * Spans inherit the event of the enclosing span on the same thread if no event is given, such that for example the wait of a
+ * module for its tasks is attributed to the event of the module.
+ */
+Tracer::Span::Span(Tracer* tracer, const char* category, std::string name, unsigned int event)
+    : tracer_(tracer), category_(category), event_(event) {
+    if(tracer_ == nullptr) {
+        return;
+    }
+
+    name_ = std::move(name);
+    if(event_ == 0) {
+        event_ = current_event;
+    }
+    previous_event_ = current_event;
+    current_event = event_;
+    start_ = std::chrono::steady_clock::now();
+}
+
+Tracer::Span::~Span() {
+    if(tracer_ == nullptr) {
+        return;
+    }
+
+    tracer_->record(category_, std::move(name_), event_, start_, std::chrono::steady_clock::now());
+    current_event = previous_event_;
+}
+
+Tracer::Tracer() : id_(next_id_++), start_(std::chrono::steady_clock::now()) {}
+
+void Tracer::setThreadName(std::string name) {
+    get_buffer().name = std::move(name);
+}
+
+void Tracer::record(const char* category,
+                    std::string name,
+                    unsigned int event,
+                    std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end) {
+    get_buffer().records.push_back({category, std::move(name), event, start, end});
+}
+
+unsigned int Tracer::getCurrentEvent() {
+    return current_event;
+}
+
+/**
+ * The buffer of the tracer last used by the calling thread is cached in a thread local variable. The buffers are only
+ * registered under a lock when a thread records its first span for a tracer.
+ */
+Tracer::ThreadBuffer& Tracer::get_buffer() {
+    thread_local std::pair<uint64_t, ThreadBuffer*> cache{0, nullptr};
+    if(cache.first == id_) {
+        return *cache.second;
+    }
+
+    std::lock_guard<std::mutex> lock{buffers_mutex_};
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->id = buffers_.size();
+    buffer->name = "Thread " + std::to_string(buffer->id);
+    cache = std::make_pair(id_, buffer.get());
+    buffers_.push_back(std::move(buffer));
+    return *cache.second;
+}
+
+/**
+ * Spans are written as complete events with their start time and duration in microseconds, and with the event number as an
+ * argument. Every thread is named by a metadata event.
+ */
+bool Tracer::write(const std::string& file_name) const {
+    std::ofstream file(file_name);
+    if(!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock{buffers_mutex_};
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    for(auto& buffer : buffers_) {
+        file << (first ? "\n" : ",\n");
+        first = false;
+        file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id
+             << ", \"args\": {\"name\": " << quote(buffer->name) << "}}";
+
+        for(auto& record : buffer->records) {
+            auto start = std::chrono::duration<double, std::micro>(record.start - start_).count();
+            auto duration = std::chrono::duration<double, std::micro>(record.end - record.start).count();
+            file << ",\n{\"name\": " << quote(record.name) << ", \"cat\": \"" << record.category
+                 << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->id << ", \"ts\": " << start
+                 << ", \"dur\": " << duration;
+            if(record.event != 0) {
+                file << ", \"args\": {\"event\": " << record.event << "}";
+            }
+            file << "}";
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Definition of the tracer recording a timeline of the module execution
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_TRACER_H
+#define ALLPIX_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace allpix {
+
+    /**
+     * @brief Recorder of time spans, written as a timeline in the Chrome trace event format
+     *
+     * Every thread records its spans into its own buffer, such that recording does not require any locking after the first
+     * span of a thread. The resulting file can be inspected with the Chrome tracing viewer or with Perfetto.
+     */
+    class Tracer {
+    public:
+        /**
+         * @brief Span which is recorded from its construction until its destruction
+         *
+         * Spans constructed without a tracer do nothing, such that instrumented code can always create them.
+         */
+        class Span {
+        public:
+            /**
+             * @brief Start a new span
+             * @param tracer Tracer to record the span in (or nullptr to not record anything)
+             * @param category Category of the span
+             * @param name Name of the span
+             * @param event Number of the event the span belongs to (zero for spans outside of any event)
+             */
+            Span(Tracer* tracer, const char* category, std::string name, unsigned int event = 0);
+            /**
+             * @brief Record the span in the tracer
+             */
+            ~Span();
+
+            /// @{
+            /**
+             * @brief Copying or moving a span is not allowed
+             */
+            Span(const Span&) = delete;
+            Span& operator=(const Span&) = delete;
+            Span(Span&&) = delete;
+            Span& operator=(Span&&) = delete;
+            /// @}
+
+        private:
+            Tracer* tracer_;
+            const char* category_;
+            std::string name_;
+            unsigned int event_;
+            unsigned int previous_event_{};
+            std::chrono::steady_clock::time_point start_;
+        };
+
+        /**
+         * @brief Construct a tracer, all times are recorded relative to its construction
+         */
+        Tracer();
+
+        /// @{
+        /**
+         * @brief Copying or moving the tracer is not allowed
+         */
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+        Tracer(Tracer&&) = delete;
+        Tracer& operator=(Tracer&&) = delete;
+        /// @}
+
+        /**
+         * @brief Use default destructor
+         */
+        ~Tracer() = default;
+
+        /**
+         * @brief Set the name of the calling thread as displayed in the timeline
+         * @param name Name of the thread
+         */
+        void setThreadName(std::string name);
+
+        /**
+         * @brief Record a finished span for the calling thread
+         * @param category Category of the span
+         * @param name Name of the span
+         * @param event Number of the event the span belongs to (zero for spans outside of any event)
+         * @param start Start time of the span
+         * @param end End time of the span
+         */
+        void record(const char* category,
+                    std::string name,
+                    unsigned int event,
+                    std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end);
+
+        /**
+         * @brief Get the event of the innermost span running on the calling thread
+         * @return Number of the event (zero if no span of an event is running)
+         */
+        static unsigned int getCurrentEvent();
+
+        /**
+         * @brief Write all recorded spans to a file in the Chrome trace event format
+         * @param file_name Path of the file to write to
+         * @return True if the file has been written, false otherwise
+         * @warning Should only be called when no other thread is recording spans
+         */
+        bool write(const std::string& file_name) const;
+
+    private:
+        struct Record {
+            const char* category;
+            std::string name;
+            unsigned int event;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::steady_clock::time_point end;
+        };
+        struct ThreadBuffer {
+            uint64_t id;
+            std::string name;
+            std::vector<Record> records;
+        };
+
+        /**
+         * @brief Get the buffer of the calling thread, creating it for the first span of the thread
+         * @return Buffer of the calling thread
+         */
+        ThreadBuffer& get_buffer();
+
+        // Unique identifier of this tracer, used to detect buffers of tracers that no longer exist
+        uint64_t id_;
+        std::chrono::steady_clock::time_point start_;
+
+        mutable std::mutex buffers_mutex_;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+
+        static std::atomic<uint64_t> next_id_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_TRACER_H */
@@ -30,9 +30,6 @@ DefaultDigitizerModule::DefaultDigitizerModule(Configuration config,
     // Require PixelCharge message for single detector
     messenger_->bindSingle(this, &DefaultDigitizerModule::pixel_message_, MsgFlags::REQUIRED);
 
-    // Seed the random generator with the global seed
-    random_generator_.seed(getRandomSeed());
-
     // Set defaults for config variables
     config_.setDefault<int>("electronics_noise", Units::get(110, "e"));
     config_.setDefault<int>("threshold", Units::get(600, "e"));
@@ -45,19 +42,29 @@ DefaultDigitizerModule::DefaultDigitizerModule(Configuration config,
 
     config_.setDefault<bool>("output_plots", false);
     config_.setDefault<int>("output_plots_scale", Units::get(30, "ke"));
+
+    // Convert the parameters used for every pixel only once
+    bind_parameter(config_, "electronics_noise", electronics_noise_);
+    bind_parameter(config_, "threshold", threshold_);
+    bind_parameter(config_, "threshold_smearing", threshold_smearing_);
+    bind_parameter(config_, "adc_resolution", adc_resolution_);
+    bind_parameter(config_, "adc_smearing", adc_smearing_);
+    bind_parameter(config_, "adc_offset", adc_offset_);
+    bind_parameter(config_, "adc_slope", adc_slope_);
+    bind_parameter(config_, "output_plots", output_plots_);
 }
 
 void DefaultDigitizerModule::init() {
     // Conversion to ADC units requested:
-    if(config_.get<int>("adc_resolution") > 31) {
+    if(adc_resolution_ > 31) {
         throw InvalidValueError(config_, "adc_resolution", "precision higher than 31bit is not possible");
     }
-    if(config_.get<int>("adc_resolution") > 0) {
-        LOG(INFO) << "Converting charge to ADC units, ADC resolution: " << config_.get<int>("adc_resolution")
-                  << "bit, max. value " << ((1 << config_.get<int>("adc_resolution")) - 1);
+    if(adc_resolution_ > 0) {
+        LOG(INFO) << "Converting charge to ADC units, ADC resolution: " << adc_resolution_
+                  << "bit, max. value " << ((1 << adc_resolution_) - 1);
     }
 
-    if(config_.get<bool>("output_plots")) {
+    if(output_plots_) {
         LOG(TRACE) << "Creating output plots";
 
         // Plot axis are in kilo electrons - convert from framework units!
@@ -74,8 +81,8 @@ void DefaultDigitizerModule::init() {
             "pixelcharge_adc_smeared", "pixel charge after ADC smearing;pixel charge [ke];pixels", nbins, 0, maximum);
 
         // Create final pixel charge plot with different axis, depending on whether ADC simulation is enabled or not
-        if(config_.get<int>("adc_resolution") > 0) {
-            int adcbins = ((1 << config_.get<int>("adc_resolution")) - 1);
+        if(adc_resolution_ > 0) {
+            int adcbins = ((1 << adc_resolution_) - 1);
             h_pxq_adc = new TH1D("pixelcharge_adc", "pixel charge after ADC;pixel charge [ADC];pixels", adcbins, 0, adcbins);
         } else {
             h_pxq_adc = new TH1D("pixelcharge_adc", "final pixel charge;pixel charge [ke];pixels", nbins, 0, maximum);
@@ -83,35 +90,37 @@ void DefaultDigitizerModule::init() {
     }
 }
 
-void DefaultDigitizerModule::run(unsigned int) {
+void DefaultDigitizerModule::run(unsigned int event_num) {
+    // Seed the random generator for this event
+    random_generator_.seed(getEventSeed(event_num));
+
     // Loop through all pixels with charges
-    std::vector<PixelHit> hits;
+    auto hits = BufferPool::acquire<PixelHit>();
     for(auto& pixel_charge : pixel_message_->getData()) {
         auto pixel = pixel_charge.getPixel();
         auto pixel_index = pixel.getIndex();
         auto charge = static_cast<double>(pixel_charge.getCharge());
 
         LOG(DEBUG) << "Received pixel " << pixel_index << ", charge " << Units::display(charge, "e");
-        if(config_.get<bool>("output_plots")) {
+        if(output_plots_) {
             h_pxq->Fill(charge / 1e3);
         }
 
         // Add electronics noise from Gaussian:
-        std::normal_distribution<double> el_noise(0, config_.get<unsigned int>("electronics_noise"));
+        std::normal_distribution<double> el_noise(0, electronics_noise_);
         charge += el_noise(random_generator_);
 
         LOG(DEBUG) << "Charge with noise: " << Units::display(charge, "e");
-        if(config_.get<bool>("output_plots")) {
+        if(output_plots_) {
             h_pxq_noise->Fill(charge / 1e3);
         }
 
         // FIXME Simulate gain / gain smearing
 
         // Smear the threshold, Gaussian distribution around "threshold" with width "threshold_smearing"
-        std::normal_distribution<double> thr_smearing(config_.get<unsigned int>("threshold"),
-                                                      config_.get<unsigned int>("threshold_smearing"));
+        std::normal_distribution<double> thr_smearing(threshold_, threshold_smearing_);
         double threshold = thr_smearing(random_generator_);
-        if(config_.get<bool>("output_plots")) {
+        if(output_plots_) {
             h_thr->Fill(threshold / 1e3);
         }
 
@@ -123,30 +132,28 @@ void DefaultDigitizerModule::run(unsigned int) {
         }
 
         LOG(DEBUG) << "Passed threshold: " << Units::display(charge, "e") << " > " << Units::display(threshold, "e");
-        if(config_.get<bool>("output_plots")) {
+        if(output_plots_) {
             h_pxq_thr->Fill(charge / 1e3);
         }
 
         // Simulate ADC if resolution set to more than 0bit
-        if(config_.get<int>("adc_resolution") > 0) {
+        if(adc_resolution_ > 0) {
             // Add ADC smearing:
-            std::normal_distribution<double> adc_smearing(0, config_.get<unsigned int>("adc_smearing"));
+            std::normal_distribution<double> adc_smearing(0, adc_smearing_);
             charge += adc_smearing(random_generator_);
-            if(config_.get<bool>("output_plots")) {
+            if(output_plots_) {
                 h_pxq_adc_smear->Fill(charge / 1e3);
             }
             LOG(DEBUG) << "Smeared for simulating limited ADC sensitivity: " << Units::display(charge, "e");
 
             // Convert to ADC units and precision:
-            charge = static_cast<double>(std::max(
-                std::min(static_cast<int>(config_.get<double>("adc_offset") + charge / config_.get<double>("adc_slope")),
-                         (1 << config_.get<int>("adc_resolution")) - 1),
-                0));
+            charge = static_cast<double>(
+                std::max(std::min(static_cast<int>(adc_offset_ + charge / adc_slope_), (1 << adc_resolution_) - 1), 0));
             LOG(DEBUG) << "Charge converted to ADC units: " << charge;
         }
 
         // Fill the final pixel charge
-        if(config_.get<bool>("output_plots")) {
+        if(output_plots_) {
             h_pxq_adc->Fill(charge);
         }
 
@@ -166,7 +173,7 @@ void DefaultDigitizerModule::run(unsigned int) {
 }
 
 void DefaultDigitizerModule::finalize() {
-    if(config_.get<bool>("output_plots")) {
+    if(output_plots_) {
         // Write histograms
         LOG(TRACE) << "Writing output plots to file";
         h_pxq->Write();
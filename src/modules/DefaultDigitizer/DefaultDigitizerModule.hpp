@@ -63,6 +63,12 @@ namespace allpix {
         Configuration config_;
         Messenger* messenger_;
 
+        // Parameters of the digitization
+        unsigned int electronics_noise_{}, threshold_{}, threshold_smearing_{}, adc_smearing_{};
+        int adc_resolution_{};
+        double adc_offset_{}, adc_slope_{};
+        bool output_plots_{};
+
         // Input message with the charges on the pixels
         std::shared_ptr<PixelChargeMessage> pixel_message_;
 
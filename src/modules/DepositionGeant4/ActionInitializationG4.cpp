@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @brief Implements the construction of the user actions for every Geant4 thread
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "ActionInitializationG4.hpp"
+
+#include <mutex>
+#include <utility>
+
+#include <G4LogicalVolume.hh>
+
+#include "DepositionGeant4Module.hpp"
+#include "GeneratorActionG4.hpp"
+#include "SensitiveDetectorActionG4.hpp"
+
+using namespace allpix;
+
+ActionInitializationG4::ActionInitializationG4(DepositionGeant4Module* module,
+                                               const BeamParameters* beam,
+                                               std::vector<std::shared_ptr<Detector>> detectors,
+                                               double charge_creation_energy,
+                                               double merge_length,
+                                               unsigned int merge_charge)
+    : module_(module), beam_(beam), detectors_(std::move(detectors)), charge_creation_energy_(charge_creation_energy),
+      merge_length_(merge_length), merge_charge_(merge_charge) {}
+
+/**
+ * The sensitive detector of a logical volume is local to the thread in multithreaded mode, such that every thread only
+ * passes its steps to its own sensitive detector actions.
+ */
+void ActionInitializationG4::Build() const {
+    // Geant4 shares the configuration of the particle source between all threads, thus only configure one at the same time
+    static std::mutex generator_mutex;
+    {
+        std::lock_guard<std::mutex> lock(generator_mutex);
+        SetUserAction(new GeneratorActionG4(module_, beam_));
+    }
+
+    // Construct the sensitive detector actions of this thread
+    for(size_t i = 0; i < detectors_.size(); ++i) {
+        // The module only passes detectors with a sensitive volume
+        auto logical_volume = detectors_[i]->getExternalObject<G4LogicalVolume>("sensor_log");
+        auto sensitive_detector_action = new SensitiveDetectorActionG4(
+            module_, detectors_[i], i, charge_creation_energy_, merge_length_, merge_charge_);
+        logical_volume->SetSensitiveDetector(sensitive_detector_action);
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file
+ * @brief Defines the construction of the user actions for every Geant4 thread
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_SIMPLE_DEPOSITION_MODULE_ACTION_INITIALIZATION_H
+#define ALLPIX_SIMPLE_DEPOSITION_MODULE_ACTION_INITIALIZATION_H
+
+#include <memory>
+#include <vector>
+
+#include <G4VUserActionInitialization.hh>
+
+#include "core/geometry/Detector.hpp"
+
+#include "GeneratorActionG4.hpp"
+
+namespace allpix {
+    class DepositionGeant4Module;
+
+    /**
+     * @brief Constructs the particle source and the sensitive detectors
+     *
+     * Geant4 builds the actions once for every thread tracking particles. In sequential mode this is the thread of the
+     * module, in multithreaded mode every worker thread of Geant4 gets its own particle source and sensitive detectors.
+     */
+    class ActionInitializationG4 : public G4VUserActionInitialization {
+    public:
+        /**
+         * @brief Constructs the action initialization
+         * @param module Pointer to the DepositionGeant4 module receiving the hits
+         * @param beam Parameters of the particle beam or a null pointer if the particles are taken from the particle bank
+         * @param detectors Detectors to add a sensitive detector action for (all with a sensitive volume)
+         * @param charge_creation_energy Energy needed per deposited charge
+         * @param merge_length Maximum distance between merged deposits of a track (or zero if not limited)
+         * @param merge_charge Maximum charge of a merged deposit (or zero if not limited)
+         */
+        ActionInitializationG4(DepositionGeant4Module* module,
+                               const BeamParameters* beam,
+                               std::vector<std::shared_ptr<Detector>> detectors,
+                               double charge_creation_energy,
+                               double merge_length,
+                               unsigned int merge_charge);
+
+        /**
+         * @brief Build the particle source and the sensitive detector actions for the calling thread
+         * @note Never throws, as exceptions cannot be propagated from the worker threads of Geant4
+         */
+        void Build() const override;
+
+    private:
+        DepositionGeant4Module* module_;
+        const BeamParameters* beam_;
+        std::vector<std::shared_ptr<Detector>> detectors_;
+        double charge_creation_energy_;
+        double merge_length_;
+        unsigned int merge_charge_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_SIMPLE_DEPOSITION_MODULE_ACTION_INITIALIZATION_H */
@@ -10,28 +10,45 @@
 
 #include "DepositionGeant4Module.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
 #include <limits>
+#include <random>
+#include <set>
+#include <stdexcept>
 #include <string>
 #include <utility>
 
 #include <G4EmParameters.hh>
 #include <G4HadronicProcessStore.hh>
 #include <G4LogicalVolume.hh>
+#include <G4ParticleTable.hh>
 #include <G4PhysListFactory.hh>
 #include <G4RunManager.hh>
+#include <Randomize.hh>
 #include <G4StepLimiterPhysics.hh>
 #include <G4UImanager.hh>
 #include <G4UserLimits.hh>
 
+#include <TROOT.h>
+
+// Include the multithreaded run manager if Geant4 is built with multithreading support
+#ifdef G4MULTITHREADED
+#include <G4MTRunManager.hh>
+#endif
+
 #include "core/config/exceptions.h"
 #include "core/geometry/GeometryManager.hpp"
+#include "core/messenger/BufferPool.hpp"
 #include "core/module/exceptions.h"
 #include "core/utils/log.h"
 #include "objects/DepositedCharge.hpp"
 #include "tools/ROOT.h"
 #include "tools/geant4.h"
 
-#include "GeneratorActionG4.hpp"
+#include "ActionInitializationG4.hpp"
 #include "SensitiveDetectorActionG4.hpp"
 
 #define G4_NUM_SEEDS 10
@@ -49,9 +66,39 @@ DepositionGeant4Module::DepositionGeant4Module(Configuration config, Messenger*
 
     // Set default physics list
     config_.setDefault("physics_list", "FTFP_BERT_LIV");
+    config_.setDefault<unsigned int>("number_of_particles", 1);
+    bind_parameter(config_, "number_of_particles", number_of_particles_);
+
+    // Read the primary particles from a particle bank if requested
+    if(config_.has("particle_bank_file")) {
+        if(config_.has("particle_bank_output_file")) {
+            throw InvalidValueError(
+                config_, "particle_bank_output_file", "cannot write a particle bank while reading from a particle bank");
+        }
+        try {
+            particle_bank_ = read_particle_bank(config_.getPath("particle_bank_file", true));
+        } catch(std::runtime_error& e) {
+            throw InvalidValueError(config_, "particle_bank_file", e.what());
+        }
+        if(particle_bank_.empty()) {
+            throw InvalidValueError(config_, "particle_bank_file", "particle bank does not contain any particles");
+        }
 
-    // Add the particle source position to the geometry
-    geo_manager_->addPoint(config_.get<ROOT::Math::XYZPoint>("beam_position"));
+        // Add the corners of the box containing all particle vertices to the geometry
+        auto min_position = particle_bank_.front().position;
+        auto max_position = particle_bank_.front().position;
+        for(auto& particle : particle_bank_) {
+            for(size_t i = 0; i < 3; ++i) {
+                min_position[i] = std::min(min_position[i], particle.position[i]);
+                max_position[i] = std::max(max_position[i], particle.position[i]);
+            }
+        }
+        geo_manager_->addPoint(ROOT::Math::XYZPoint(min_position[0], min_position[1], min_position[2]));
+        geo_manager_->addPoint(ROOT::Math::XYZPoint(max_position[0], max_position[1], max_position[2]));
+    } else {
+        // Add the particle source position to the geometry
+        geo_manager_->addPoint(config_.get<ROOT::Math::XYZPoint>("beam_position"));
+    }
 }
 
 /**
@@ -135,18 +182,52 @@ void DepositionGeant4Module::init() {
     run_manager_g4_->SetUserInitialization(physicsList);
     run_manager_g4_->InitializePhysics();
 
-    // Initialize the full run manager to ensure correct state flags
-    run_manager_g4_->Initialize();
+    // Check if Geant4 knows all particles in the particle bank
+    std::set<int32_t> pdg_codes;
+    for(auto& particle : particle_bank_) {
+        pdg_codes.insert(particle.pdg_code);
+    }
+    for(auto pdg_code : pdg_codes) {
+        if(G4ParticleTable::GetParticleTable()->FindParticle(pdg_code) == nullptr) {
+            throw InvalidValueError(
+                config_, "particle_bank_file", "particle bank contains unknown particle code " + std::to_string(pdg_code));
+        }
+    }
+    if(!particle_bank_.empty()) {
+        LOG(INFO) << "Using " << particle_bank_.size() << " primary particles from particle bank";
+    } else {
+        // Validate the beam here, the particle source is constructed in the worker threads which cannot throw
+        read_beam();
+    }
 
-    // Build particle generator
-    LOG(TRACE) << "Constructing particle source";
-    auto generator = new GeneratorActionG4(config_);
-    run_manager_g4_->SetUserAction(generator);
+    // Open the particle bank to write the primary particles to if requested
+    if(config_.has("particle_bank_output_file")) {
+        auto file_name = getOutputPath(config_.get<std::string>("particle_bank_output_file"), true);
+        bank_output_.open(file_name, std::ios::binary | std::ios::trunc);
+        if(!bank_output_) {
+            throw InvalidValueError(config_, "particle_bank_output_file", "cannot open particle bank for writing");
+        }
+        write_particle_bank_header(bank_output_);
+        write_bank_ = true;
+        LOG(INFO) << "Writing primary particles to particle bank " << file_name;
+    }
 
     // Get the creation energy for charge (default is silicon electron hole pair energy)
     auto charge_creation_energy = config_.get<double>("charge_creation_energy", Units::get(3.64, "eV"));
 
-    // Loop through all detectors and set the sensitive detector action that handles the particle passage
+    // Get the limits for merging the deposits of consecutive steps of a track (disabled by default)
+    auto merge_length = config_.get<double>("deposit_merge_length", 0);
+    if(merge_length < 0) {
+        throw InvalidValueError(config_, "deposit_merge_length", "merge length should not be negative");
+    }
+    auto merge_charge = config_.get<unsigned int>("deposit_merge_charge", 0);
+    if(merge_length > 0 || merge_charge > 0) {
+        LOG(INFO) << "Merging deposits of tracks into deposits of at most "
+                  << (merge_length > 0 ? Units::display(merge_length, {"um", "mm"}) : "unlimited length") << " and "
+                  << (merge_charge > 0 ? std::to_string(merge_charge) : "unlimited") << " charges";
+    }
+
+    // Loop through all detectors to find the sensitive devices that should handle the particle passage
     bool useful_deposition = false;
     for(auto& detector : geo_manager_->getDetectors()) {
         // Do not add sensitive detector for detectors that have no listeners for the deposited charges
@@ -160,7 +241,6 @@ void DepositionGeant4Module::init() {
         useful_deposition = true;
 
         // Get model of the sensitive device
-        auto sensitive_detector_action = new SensitiveDetectorActionG4(this, detector, messenger_, charge_creation_energy);
         auto logical_volume = detector->getExternalObject<G4LogicalVolume>("sensor_log");
         if(logical_volume == nullptr) {
             throw ModuleError("Detector " + detector->getName() + " has no sensitive device (broken Geant4 geometry)");
@@ -168,11 +248,43 @@ void DepositionGeant4Module::init() {
 
         // Apply the user limits to this element
         logical_volume->SetUserLimits(user_limits_.get());
+        sensors_.push_back(detector);
+    }
+
+    // Simulate a block of events with a single run of Geant4, by default a single event or one event for every thread
+    unsigned int geant4_threads = 0;
+#ifdef G4MULTITHREADED
+    auto mt_run_manager = dynamic_cast<G4MTRunManager*>(run_manager_g4_);
+    if(mt_run_manager != nullptr) {
+        geant4_threads = static_cast<unsigned int>(std::max(mt_run_manager->GetNumberOfThreads(), 1));
 
-        // Add the sensitive detector action
-        logical_volume->SetSensitiveDetector(sensitive_detector_action);
-        sensors_.push_back(sensitive_detector_action);
+        // The objects of the deposits are created in the worker threads
+        ROOT::EnableThreadSafety();
+    }
+#endif
+    config_.setDefault<unsigned int>("events_per_block", std::max(geant4_threads, 1u));
+    events_per_block_ = config_.get<unsigned int>("events_per_block");
+    if(events_per_block_ == 0) {
+        throw InvalidValueError(config_, "events_per_block", "number of events per block should be strictly more than zero");
     }
+    number_of_events_ = config_.get<unsigned int>("_number_of_events", 1u);
+    if(geant4_threads != 0) {
+        LOG(INFO) << "Distributing blocks of " << events_per_block_ << " events over " << geant4_threads
+                  << " Geant4 worker threads";
+        if(events_per_block_ < geant4_threads) {
+            LOG(WARNING) << "Less events per block than Geant4 worker threads, not all threads will be used";
+        }
+    } else if(events_per_block_ > 1) {
+        LOG(INFO) << "Simulating blocks of " << events_per_block_ << " events in a single Geant4 run";
+    }
+
+    // Build the particle generator and the sensitive detector actions (in every worker thread if multithreaded)
+    LOG(TRACE) << "Constructing particle source and sensitive detectors";
+    run_manager_g4_->SetUserInitialization(new ActionInitializationG4(
+        this, particle_bank_.empty() ? &beam_ : nullptr, sensors_, charge_creation_energy, merge_length, merge_charge));
+
+    // Initialize the full run manager to ensure correct state flags
+    run_manager_g4_->Initialize();
 
     if(!useful_deposition) {
         LOG(ERROR) << "Not a single listener for deposited charges, module is useless!";
@@ -199,38 +311,252 @@ void DepositionGeant4Module::init() {
     RELEASE_STREAM(G4cout);
 }
 
+void DepositionGeant4Module::read_beam() {
+    // Find Geant4 particle
+    auto pdg_table = G4ParticleTable::GetParticleTable();
+    auto particle_type = config_.get<std::string>("particle_type", "");
+    std::transform(particle_type.begin(), particle_type.end(), particle_type.begin(), ::tolower);
+    auto particle_code = config_.get<int>("particle_code", 0);
+    G4ParticleDefinition* particle = nullptr;
+
+    if(!particle_type.empty() && particle_code != 0) {
+        if(pdg_table->FindParticle(particle_type) == pdg_table->FindParticle(particle_code)) {
+            LOG(WARNING) << "particle_type and particle_code given. Continuing because they match.";
+            particle = pdg_table->FindParticle(particle_code);
+            if(particle == nullptr) {
+                throw InvalidValueError(config_, "particle_code", "particle code does not exist.");
+            }
+        } else {
+            throw InvalidValueError(
+                config_, "particle_type", "Given particle_type does not match particle_code. Please remove one of them.");
+        }
+    } else if(particle_type.empty() && particle_code == 0) {
+        throw InvalidValueError(config_, "particle_code", "Please set particle_code or particle_type.");
+    } else if(particle_code != 0) {
+        particle = pdg_table->FindParticle(particle_code);
+        if(particle == nullptr) {
+            throw InvalidValueError(config_, "particle_code", "particle code does not exist.");
+        }
+    } else {
+        particle = pdg_table->FindParticle(particle_type);
+        if(particle == nullptr) {
+            throw InvalidValueError(config_, "particle_type", "particle type does not exist.");
+        }
+    }
+
+    LOG(DEBUG) << "Using particle " << particle->GetParticleName() << " (ID " << particle->GetPDGEncoding() << ").";
+    beam_.particle = particle;
+
+    // Get the parameters of the position, angle and energy distribution
+    beam_.size = config_.get<double>("beam_size", 0);
+    beam_.position = config_.get<G4ThreeVector>("beam_position");
+    beam_.divergence = config_.get<G4TwoVector>("beam_divergence", G4TwoVector(0., 0.));
+    beam_.direction = config_.get<G4ThreeVector>("beam_direction");
+    if(fabs(beam_.direction.mag() - 1.0) > std::numeric_limits<double>::epsilon()) {
+        LOG(WARNING) << "Momentum direction is not a unit vector: magnitude is ignored";
+    }
+    beam_.energy = config_.get<double>("beam_energy");
+    beam_.energy_spread = config_.get<double>("beam_energy_spread", 0.);
+}
+
 void DepositionGeant4Module::run(unsigned int event_num) {
+    // Simulate a new block of events if the event is not part of the current block
+    if(block_hits_.empty() || event_num < block_first_event_ || event_num >= block_first_event_ + block_events_) {
+        run_block(event_num);
+    }
+    last_event_num_ = event_num;
+
+    // Dispatch the necessary messages
+    dispatch_hits(event_num);
+}
+
+void DepositionGeant4Module::run_block(unsigned int event_num) {
     // Suppress output stream if not in debugging mode
     IFLOG(DEBUG);
     else {
         SUPPRESS_STREAM(G4cout);
     }
 
-    // Start a single event from the beam
-    LOG(TRACE) << "Enabling beam";
-    run_manager_g4_->BeamOn(static_cast<int>(config_.get<unsigned int>("number_of_particles", 1)));
-    last_event_num_ = event_num;
+    // Do not simulate more events than requested in the last block
+    block_first_event_ = event_num;
+    block_events_ = std::min(events_per_block_, (number_of_events_ >= event_num ? number_of_events_ - event_num + 1 : 1u));
+
+    // Prepare the storage of the hits for every Geant4 event of the block
+    block_hits_.resize(static_cast<size_t>(block_events_) * number_of_particles_);
+    for(auto& event_hits : block_hits_) {
+        event_hits.resize(sensors_.size());
+    }
+    if(write_bank_) {
+        block_primaries_.resize(block_hits_.size());
+    }
+
+    // Start the events of the block from the beam
+    LOG(TRACE) << "Enabling beam for " << block_events_ << " event(s)";
+    run_manager_g4_->BeamOn(static_cast<int>(block_hits_.size()));
 
     // Release the stream (if it was suspended)
     RELEASE_STREAM(G4cout);
+}
 
-    // Dispatch the necessary messages
-    for(auto& sensor : sensors_) {
-        sensor->dispatchMessages();
+/**
+ * The hits are stored in the slot of their Geant4 event, which is only accessed by the thread processing that event. The
+ * storage is not resized during a run, such that no locking is required.
+ */
+void DepositionGeant4Module::storeHits(int event_id, size_t sensor_index, SensorHits hits) {
+    block_hits_.at(static_cast<size_t>(event_id)).at(sensor_index) = std::move(hits);
+}
+
+/**
+ * Every particle of an event is a separate Geant4 event. All Geant4 events of an event are seeded from the seed of that
+ * event, such that the result does not depend on the size of the block or on the thread processing the event.
+ */
+void DepositionGeant4Module::seedEvent(int event_id) const {
+    auto event_index = static_cast<unsigned int>(event_id) / number_of_particles_;
+    auto particle_index = static_cast<unsigned int>(event_id) % number_of_particles_;
+
+    std::mt19937_64 event_seeder(getEventSeed(block_first_event_ + event_index));
+    event_seeder.discard(static_cast<unsigned long long>(particle_index) * G4_NUM_SEEDS);
+    std::array<long, G4_NUM_SEEDS + 1> seeds{};
+    for(int i = 0; i < G4_NUM_SEEDS; ++i) {
+        seeds.at(static_cast<size_t>(i)) = static_cast<long>(event_seeder() % INT_MAX);
+    }
+    G4Random::setTheSeeds(seeds.data());
+}
+
+/**
+ * The particles are taken from the bank in the order of the events and their particles, starting again from the first
+ * particle if the bank is exhausted. An event thus always uses the same particles, independent of the block and the thread.
+ */
+const BankParticle& DepositionGeant4Module::getBankParticle(int event_id) const {
+    auto event_index = static_cast<uint64_t>(event_id) / number_of_particles_;
+    auto particle_index = static_cast<uint64_t>(event_id) % number_of_particles_;
+    auto particle_number = (block_first_event_ - 1 + event_index) * number_of_particles_ + particle_index;
+    return particle_bank_[particle_number % particle_bank_.size()];
+}
+
+void DepositionGeant4Module::storePrimary(int event_id, const BankParticle& particle) {
+    if(write_bank_) {
+        block_primaries_.at(static_cast<size_t>(event_id)) = particle;
+    }
+}
+
+void DepositionGeant4Module::dispatch_hits(unsigned int event_num) {
+    auto first_hits = static_cast<size_t>(event_num - block_first_event_) * number_of_particles_;
+
+    // Append the primary particles of the event to the particle bank, in the order of the events
+    if(write_bank_) {
+        for(size_t i = first_hits; i < first_hits + number_of_particles_; ++i) {
+            write_bank_particle(bank_output_, block_primaries_[i]);
+        }
+        written_particles_ += number_of_particles_;
+    }
+
+    for(size_t sensor_index = 0; sensor_index < sensors_.size(); ++sensor_index) {
+        auto& detector = sensors_[sensor_index];
+
+        // Combine the hits of all particles of the event
+        auto mc_particles = BufferPool::acquire<MCParticle>();
+        auto deposits = BufferPool::acquire<DepositedCharge>();
+        particle_parents_.clear();
+        deposit_particles_.clear();
+        for(size_t i = first_hits; i < first_hits + number_of_particles_; ++i) {
+            auto& hits = block_hits_[i][sensor_index];
+
+            auto offset = mc_particles.size();
+            for(auto parent : hits.particle_parents) {
+                particle_parents_.push_back(parent == std::numeric_limits<size_t>::max() ? parent : parent + offset);
+            }
+            for(auto particle : hits.deposit_particles) {
+                deposit_particles_.push_back(particle + offset);
+            }
+
+            if(mc_particles.empty()) {
+                mc_particles.swap(hits.particles);
+            } else {
+                std::move(hits.particles.begin(), hits.particles.end(), std::back_inserter(mc_particles));
+            }
+            if(deposits.empty()) {
+                deposits.swap(hits.deposits);
+            } else {
+                std::move(hits.deposits.begin(), hits.deposits.end(), std::back_inserter(deposits));
+            }
+
+            // Return the remaining memory of the hits
+            BufferPool::release(std::move(hits.particles));
+            BufferPool::release(std::move(hits.particle_parents));
+            BufferPool::release(std::move(hits.deposits));
+            BufferPool::release(std::move(hits.deposit_particles));
+            hits = SensorHits();
+        }
+
+        // Link mc particles to parents
+        for(size_t i = 0; i < mc_particles.size(); ++i) {
+            if(particle_parents_[i] != std::numeric_limits<size_t>::max()) {
+                mc_particles[i].setParent(&mc_particles[particle_parents_[i]]);
+            }
+        }
+
+        // Send the mc particle information
+        auto mc_particle_message = std::make_shared<MCParticleMessage>(std::move(mc_particles), detector);
+        messenger_->dispatchMessage(this, mc_particle_message);
+
+        // Send a deposit message if we have any deposits
+        if(deposits.empty()) {
+            BufferPool::release(std::move(deposits));
+            continue;
+        }
+
+        unsigned int charges = 0;
+        for(auto& ch : deposits) {
+            charges += ch.getCharge();
+        }
+        total_charges_ += charges;
+        LOG(INFO) << "Deposited " << charges << " charges in sensor of detector " << detector->getName();
+
+        // Match deposit with mc particle
+        auto& particles = mc_particle_message->getData();
+        for(size_t i = 0; i < deposits.size(); ++i) {
+            deposits[i].setMCParticle(&particles[deposit_particles_[i]]);
+        }
+
+        // Report the charge linked to every mc particle
+        IFLOG(DEBUG) {
+            std::vector<unsigned int> particle_charges(particles.size(), 0);
+            for(size_t i = 0; i < deposits.size(); ++i) {
+                particle_charges[deposit_particles_[i]] += deposits[i].getCharge();
+            }
+            for(size_t i = 0; i < particle_charges.size(); ++i) {
+                LOG(DEBUG) << "MC particle " << i << " (PDG code " << particles[i].getParticleID() << ") in detector "
+                           << detector->getName() << " has " << particle_charges[i] << " linked charges";
+            }
+        }
+
+        // Create and dispatch the charge deposit message
+        auto deposit_message = std::make_shared<DepositedChargeMessage>(std::move(deposits), detector);
+        messenger_->dispatchMessage(this, deposit_message);
     }
 }
 
 void DepositionGeant4Module::finalize() {
-    size_t total_charges = 0;
-    for(auto& sensor : sensors_) {
-        total_charges += sensor->getTotalDepositedCharge();
+    // Close the particle bank
+    if(write_bank_) {
+        bank_output_.close();
+        if(!bank_output_) {
+            throw ModuleError("Failed to write particle bank");
+        }
+        LOG(INFO) << "Wrote " << written_particles_ << " primary particles to particle bank";
+    }
+    auto used_particles = static_cast<uint64_t>(last_event_num_) * number_of_particles_;
+    if(!particle_bank_.empty() && used_particles > particle_bank_.size()) {
+        LOG(WARNING) << "Particle bank of " << particle_bank_.size() << " particles is reused for " << used_particles
+                     << " particles";
     }
 
     // Print summary or warns if module did not output any charges
-    if(!sensors_.empty() && total_charges > 0 && last_event_num_ > 0) {
-        size_t average_charge = total_charges / sensors_.size() / last_event_num_;
-        LOG(INFO) << "Deposited total of " << total_charges << " charges in " << sensors_.size() << " sensor(s) (average of "
-                  << average_charge << " per sensor for every event)";
+    if(!sensors_.empty() && total_charges_ > 0 && last_event_num_ > 0) {
+        size_t average_charge = total_charges_ / sensors_.size() / last_event_num_;
+        LOG(INFO) << "Deposited total of " << total_charges_ << " charges in " << sensors_.size()
+                  << " sensor(s) (average of " << average_charge << " per sensor for every event)";
     } else {
         LOG(WARNING) << "No charges deposited";
     }
@@ -10,14 +10,19 @@
 #ifndef ALLPIX_SIMPLE_DEPOSITION_MODULE_H
 #define ALLPIX_SIMPLE_DEPOSITION_MODULE_H
 
+#include <cstdint>
+#include <fstream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/config/Configuration.hpp"
 #include "core/geometry/GeometryManager.hpp"
 #include "core/messenger/Messenger.hpp"
 #include "core/module/Module.hpp"
 
+#include "GeneratorActionG4.hpp"
+#include "ParticleBank.hpp"
 #include "SensitiveDetectorActionG4.hpp"
 
 class G4UserLimits;
@@ -32,6 +37,10 @@ namespace allpix {
      * hits the sensor the energy loss is converted to charge deposits using the electron-hole creation energy. The energy
      * deposits are specific for a detector. The module also returns the information of the real particle passage (the
      * MCParticle).
+     *
+     * Geant4 simulates a block of events at once, the hits of every Geant4 event are stored by the sensitive detectors and
+     * dispatched in the run of the event they belong to. If the Geant4 run manager is multithreaded, the events of a block
+     * are distributed over its worker threads.
      */
     class DepositionGeant4Module : public Module {
     public:
@@ -58,13 +67,95 @@ namespace allpix {
          */
         void finalize() override;
 
+        /**
+         * @brief Store the hits of a sensor in a Geant4 event of the current block
+         * @param event_id Identifier of the Geant4 event in the current run
+         * @param sensor_index Index of the sensor
+         * @param hits Deposits and particles of the sensor
+         * @note Called by the sensitive detectors in all Geant4 threads, every event and sensor is only stored once
+         */
+        void storeHits(int event_id, size_t sensor_index, SensorHits hits);
+
+        /**
+         * @brief Reseed the random engine of the calling thread for a Geant4 event of the current block
+         * @param event_id Identifier of the Geant4 event in the current run
+         */
+        void seedEvent(int event_id) const;
+
+        /**
+         * @brief Get the primary particle from the particle bank for a Geant4 event of the current block
+         * @param event_id Identifier of the Geant4 event in the current run
+         * @return Particle of the bank to simulate in the Geant4 event
+         * @warning Should only be called if a particle bank is read
+         */
+        const BankParticle& getBankParticle(int event_id) const;
+
+        /**
+         * @brief Store the primary particle of a Geant4 event of the current block to write it to the particle bank
+         * @param event_id Identifier of the Geant4 event in the current run
+         * @param particle Primary particle sampled from the particle source
+         * @note Ignored if no particle bank is written
+         */
+        void storePrimary(int event_id, const BankParticle& particle);
+
     private:
+        /**
+         * @brief Simulate the Geant4 events of a block of events
+         * @param event_num Number of the first event in the block
+         */
+        void run_block(unsigned int event_num);
+
+        /**
+         * @brief Send the MCParticle and DepositedCharge messages of all sensors for an event of the current block
+         * @param event_num Number of the event
+         */
+        void dispatch_hits(unsigned int event_num);
+
+        /**
+         * @brief Read and validate the parameters of the particle beam
+         * @note Requires the particle table of Geant4 to be constructed
+         */
+        void read_beam();
+
         Configuration config_;
         Messenger* messenger_;
         GeometryManager* geo_manager_;
 
-        // Handling of the charge deposition in all the sensitive devices
-        std::vector<SensitiveDetectorActionG4*> sensors_;
+        // Number of particles to generate in every event
+        unsigned int number_of_particles_{};
+
+        // Detectors with a sensitive detector action, in the order of their index
+        std::vector<std::shared_ptr<Detector>> sensors_;
+
+        // Number of events simulated by Geant4 at once
+        unsigned int events_per_block_{1};
+        // Total number of events of the simulation, to not simulate more events in the last block
+        unsigned int number_of_events_{1};
+        // Number of the first event and number of events of the current block
+        unsigned int block_first_event_{};
+        unsigned int block_events_{};
+        // Hits of every sensor for all Geant4 events of the current block
+        std::vector<std::vector<SensorHits>> block_hits_;
+
+        // Parameters of the particle beam if the particles are not taken from the particle bank
+        BeamParameters beam_;
+
+        // Particles read from the particle bank to use as primaries
+        std::vector<BankParticle> particle_bank_;
+
+        // Particle bank to write the primaries of all events to
+        bool write_bank_{};
+        std::ofstream bank_output_;
+        // Primary particles of all Geant4 events of the current block
+        std::vector<BankParticle> block_primaries_;
+        uint64_t written_particles_{};
+
+        // Scratch space for the links of the objects of a sensor in an event
+        std::vector<size_t> particle_parents_;
+        std::vector<size_t> deposit_particles_;
+
+        // Statistics of total deposited charge
+        unsigned long total_charges_{};
 
         // Number of the last event
         unsigned int last_event_num_;
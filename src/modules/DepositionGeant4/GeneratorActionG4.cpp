@@ -10,95 +10,88 @@
 
 #include "GeneratorActionG4.hpp"
 
-#include <limits>
 #include <memory>
+#include <utility>
 
 #include <G4Event.hh>
 #include <G4GeneralParticleSource.hh>
 #include <G4ParticleDefinition.hh>
-#include <G4ParticleTable.hh>
+#include <G4PrimaryParticle.hh>
+#include <G4PrimaryVertex.hh>
 
-#include "core/config/exceptions.h"
-#include "core/utils/log.h"
 #include "tools/geant4.h"
 
+#include "DepositionGeant4Module.hpp"
+
 using namespace allpix;
 
-GeneratorActionG4::GeneratorActionG4(const Configuration& config)
-    : particle_source_(std::make_unique<G4GeneralParticleSource>()) {
+GeneratorActionG4::GeneratorActionG4(DepositionGeant4Module* module, const BeamParameters* beam) : module_(module) {
+    // Do not construct a particle source if the particles are taken from a particle bank
+    if(beam == nullptr) {
+        return;
+    }
+
     // Set verbosity of source to off
+    particle_source_ = std::make_unique<G4GeneralParticleSource>();
     particle_source_->SetVerbosity(0);
 
     // Get source specific parameters
     auto single_source = particle_source_->GetCurrentSource();
 
-    // Find Geant4 particle
-    auto pdg_table = G4ParticleTable::GetParticleTable();
-    auto particle_type = config.get<std::string>("particle_type", "");
-    std::transform(particle_type.begin(), particle_type.end(), particle_type.begin(), ::tolower);
-    auto particle_code = config.get<int>("particle_code", 0);
-    G4ParticleDefinition* particle = nullptr;
-
-    if(!particle_type.empty() && particle_code != 0) {
-        if(pdg_table->FindParticle(particle_type) == pdg_table->FindParticle(particle_code)) {
-            LOG(WARNING) << "particle_type and particle_code given. Continuing because they match.";
-            particle = pdg_table->FindParticle(particle_code);
-            if(particle == nullptr) {
-                throw InvalidValueError(config, "particle_code", "particle code does not exist.");
-            }
-        } else {
-            throw InvalidValueError(
-                config, "particle_type", "Given particle_type does not match particle_code. Please remove one of them.");
-        }
-    } else if(particle_type.empty() && particle_code == 0) {
-        throw InvalidValueError(config, "particle_code", "Please set particle_code or particle_type.");
-    } else if(particle_code != 0) {
-        particle = pdg_table->FindParticle(particle_code);
-        if(particle == nullptr) {
-            throw InvalidValueError(config, "particle_code", "particle code does not exist.");
-        }
-    } else {
-        particle = pdg_table->FindParticle(particle_type);
-        if(particle == nullptr) {
-            throw InvalidValueError(config, "particle_type", "particle type does not exist.");
-        }
-    }
-
-    LOG(DEBUG) << "Using particle " << particle->GetParticleName() << " (ID " << particle->GetPDGEncoding() << ").";
-
     // Set global parameters of the source
     // FIXME keep number of particles always at one?
     single_source->SetNumberOfParticles(1);
-    single_source->SetParticleDefinition(particle);
+    single_source->SetParticleDefinition(beam->particle);
     // FIXME What is this time
     single_source->SetParticleTime(0.0);
 
     // Set position parameters
     single_source->GetPosDist()->SetPosDisType("Beam");
-    single_source->GetPosDist()->SetBeamSigmaInR(config.get<double>("beam_size", 0));
-    single_source->GetPosDist()->SetCentreCoords(config.get<G4ThreeVector>("beam_position"));
+    single_source->GetPosDist()->SetBeamSigmaInR(beam->size);
+    single_source->GetPosDist()->SetCentreCoords(beam->position);
 
     // Set angle distribution parameters
     single_source->GetAngDist()->SetAngDistType("beam2d");
     single_source->GetAngDist()->DefineAngRefAxes("angref1", G4ThreeVector(-1., 0, 0));
-    G4TwoVector divergence = config.get<G4TwoVector>("beam_divergence", G4TwoVector(0., 0.));
-    single_source->GetAngDist()->SetBeamSigmaInAngX(divergence.x());
-    single_source->GetAngDist()->SetBeamSigmaInAngY(divergence.y());
-    G4ThreeVector direction = config.get<G4ThreeVector>("beam_direction");
-    if(fabs(direction.mag() - 1.0) > std::numeric_limits<double>::epsilon()) {
-        LOG(WARNING) << "Momentum direction is not a unit vector: magnitude is ignored";
-    }
-    single_source->GetAngDist()->SetParticleMomentumDirection(direction);
+    single_source->GetAngDist()->SetBeamSigmaInAngX(beam->divergence.x());
+    single_source->GetAngDist()->SetBeamSigmaInAngY(beam->divergence.y());
+    single_source->GetAngDist()->SetParticleMomentumDirection(beam->direction);
 
     // Set energy parameters
     single_source->GetEneDist()->SetEnergyDisType("Gauss");
-    single_source->GetEneDist()->SetMonoEnergy(config.get<double>("beam_energy"));
-    single_source->GetEneDist()->SetBeamSigmaInE(config.get<double>("beam_energy_spread", 0.));
+    single_source->GetEneDist()->SetMonoEnergy(beam->energy);
+    single_source->GetEneDist()->SetBeamSigmaInE(beam->energy_spread);
 }
 
 /**
- * Called automatically for every event
+ * Called automatically for every event, before any random number of the event is used. The random engine is reseeded for
+ * every event, such that the result does not depend on the thread processing the event.
  */
 void GeneratorActionG4::GeneratePrimaries(G4Event* event) {
+    module_->seedEvent(event->GetEventID());
+
+    // Take the particle from the bank if available
+    if(particle_source_ == nullptr) {
+        auto& particle = module_->getBankParticle(event->GetEventID());
+        auto position = G4ThreeVector(particle.position[0], particle.position[1], particle.position[2]);
+        auto vertex = new G4PrimaryVertex(position, 0.);
+        auto primary = new G4PrimaryParticle(particle.pdg_code);
+        primary->SetMomentumDirection(G4ThreeVector(particle.direction[0], particle.direction[1], particle.direction[2]));
+        primary->SetKineticEnergy(particle.energy);
+        vertex->SetPrimary(primary);
+        event->AddPrimaryVertex(vertex);
+        return;
+    }
+
+    // Sample the particle from the source and pass it to the module to store it in a bank if requested
     particle_source_->GeneratePrimaryVertex(event);
+    auto vertex = event->GetPrimaryVertex(0);
+    auto primary = vertex->GetPrimary();
+    BankParticle particle{};
+    particle.position = {{vertex->GetX0(), vertex->GetY0(), vertex->GetZ0()}};
+    auto direction = primary->GetMomentumDirection();
+    particle.direction = {{direction.x(), direction.y(), direction.z()}};
+    particle.energy = primary->GetKineticEnergy();
+    particle.pdg_code = primary->GetPDGcode();
+    module_->storePrimary(event->GetEventID(), particle);
 }
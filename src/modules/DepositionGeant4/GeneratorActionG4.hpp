@@ -19,19 +19,38 @@
 #include <G4TwoVector.hh>
 #include <G4VUserPrimaryGeneratorAction.hh>
 
-#include "core/config/Configuration.hpp"
-
 namespace allpix {
+    class DepositionGeant4Module;
+
+    /**
+     * @brief Parameters of the particle beam, read from the configuration of the module before Geant4 is initialized
+     */
+    struct BeamParameters {
+        G4ParticleDefinition* particle{};
+        double energy{};
+        double energy_spread{};
+        G4ThreeVector position;
+        double size{};
+        G4ThreeVector direction;
+        G4TwoVector divergence;
+    };
+
     /**
      * @brief Generates the particles in every event
+     *
+     * The particles are either sampled from a general particle source or taken from the particle bank of the module.
      */
     class GeneratorActionG4 : public G4VUserPrimaryGeneratorAction {
     public:
         /**
          * @brief Constructs the generator action
-         * @param config Configuration of the \ref DepositionGeant4Module module
+         * @param module Pointer to the DepositionGeant4 module holding this class
+         * @param beam Parameters of the particle beam or a null pointer if the particles are taken from the particle bank
+         *
+         * The beam parameters are validated by the module, such that constructing the generator in a worker thread of
+         * Geant4 never throws.
          */
-        explicit GeneratorActionG4(const Configuration& config);
+        GeneratorActionG4(DepositionGeant4Module* module, const BeamParameters* beam);
 
         /**
          * @brief Generate the particle for every event
@@ -39,6 +58,7 @@ namespace allpix {
         void GeneratePrimaries(G4Event*) override;
 
     private:
+        DepositionGeant4Module* module_;
         std::unique_ptr<G4GeneralParticleSource> particle_source_;
     };
 } // namespace allpix
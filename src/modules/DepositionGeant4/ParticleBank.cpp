@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Implements the storage of primary particles in a binary particle bank
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include "ParticleBank.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+using namespace allpix;
+
+namespace {
+    // Identifier at the start of every particle bank, followed by the version, the byte order and the size of the records
+    const std::array<char, 8> bank_magic{{'A', 'P', 'S', 'Q', 'B', 'A', 'N', 'K'}};
+    const uint32_t bank_version = 2;
+    const uint32_t bank_byte_order = 0x01020304;
+    const uint32_t swapped_byte_order = 0x04030201;
+    const uint32_t record_size = sizeof(BankParticle);
+} // namespace
+
+static_assert(sizeof(BankParticle) == 64, "particle bank records should not contain any padding");
+
+/**
+ * The header of the bank is checked to ensure the records have been written in the same layout and byte order.
+ */
+std::vector<BankParticle> allpix::read_particle_bank(const std::string& file_name) {
+    std::ifstream file(file_name, std::ios::binary);
+    if(!file) {
+        throw std::runtime_error("cannot open particle bank");
+    }
+
+    std::array<char, 8> magic{};
+    uint32_t version = 0;
+    uint32_t byte_order = 0;
+    uint32_t size = 0;
+    file.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&byte_order), sizeof(byte_order));
+    file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if(!file || magic != bank_magic) {
+        throw std::runtime_error("file is not a particle bank");
+    }
+    if(byte_order == swapped_byte_order) {
+        throw std::runtime_error("particle bank has been written on a machine with another byte order");
+    }
+    if(version != bank_version) {
+        throw std::runtime_error("particle bank has version " + std::to_string(version) + ", expected version " +
+                                 std::to_string(bank_version));
+    }
+    if(byte_order != bank_byte_order) {
+        throw std::runtime_error("particle bank has an unknown byte order");
+    }
+    if(size != record_size) {
+        throw std::runtime_error("particle bank has records of " + std::to_string(size) + " bytes, expected records of " +
+                                 std::to_string(record_size) + " bytes");
+    }
+
+    // Read all records at once
+    auto begin = file.tellg();
+    file.seekg(0, std::ios::end);
+    auto bytes = static_cast<size_t>(file.tellg() - begin);
+    file.seekg(begin);
+    if(bytes % record_size != 0) {
+        throw std::runtime_error("particle bank is truncated");
+    }
+
+    std::vector<BankParticle> particles(bytes / record_size);
+    file.read(reinterpret_cast<char*>(particles.data()), static_cast<std::streamsize>(bytes));
+    if(!file) {
+        throw std::runtime_error("cannot read particles from particle bank");
+    }
+    return particles;
+}
+
+void allpix::write_particle_bank_header(std::ostream& stream) {
+    stream.write(bank_magic.data(), static_cast<std::streamsize>(bank_magic.size()));
+    stream.write(reinterpret_cast<const char*>(&bank_version), sizeof(bank_version));
+    stream.write(reinterpret_cast<const char*>(&bank_byte_order), sizeof(bank_byte_order));
+    stream.write(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+}
+
+void allpix::write_bank_particle(std::ostream& stream, const BankParticle& particle) {
+    stream.write(reinterpret_cast<const char*>(&particle), sizeof(particle));
+}
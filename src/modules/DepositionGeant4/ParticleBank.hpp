@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Defines the storage of primary particles in a binary particle bank
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_SIMPLE_DEPOSITION_MODULE_PARTICLE_BANK_H
+#define ALLPIX_SIMPLE_DEPOSITION_MODULE_PARTICLE_BANK_H
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace allpix {
+    /**
+     * @brief Primary particle stored in a particle bank
+     *
+     * All quantities are stored in the internal units of the framework. The particles are stored as raw records in the byte
+     * order of the machine writing the bank, which is recorded in the header of the bank. Banks written with another byte
+     * order are rejected when reading them.
+     */
+    struct BankParticle {
+        // Position of the vertex in the world frame
+        std::array<double, 3> position;
+        // Unit vector of the direction of the momentum
+        std::array<double, 3> direction;
+        // Kinetic energy of the particle
+        double energy;
+        // PDG code of the particle
+        int32_t pdg_code;
+        // Padding to keep the size of the record fixed
+        int32_t reserved;
+    };
+
+    /**
+     * @brief Read all particles from a particle bank
+     * @param file_name Path to the file of the bank
+     * @return List of the particles in the order of the bank
+     * @throws std::runtime_error If the file cannot be read or is not a valid particle bank
+     */
+    std::vector<BankParticle> read_particle_bank(const std::string& file_name);
+
+    /**
+     * @brief Write the header identifying a particle bank
+     * @param stream Stream to write the bank to
+     */
+    void write_particle_bank_header(std::ostream& stream);
+
+    /**
+     * @brief Append a particle to a particle bank
+     * @param stream Stream to write the bank to, after the header of the bank
+     * @param particle Particle to append
+     */
+    void write_bank_particle(std::ostream& stream, const BankParticle& particle);
+} // namespace allpix
+
+#endif /* ALLPIX_SIMPLE_DEPOSITION_MODULE_PARTICLE_BANK_H */
@@ -10,9 +10,13 @@
 
 #include "SensitiveDetectorActionG4.hpp"
 
+#include <limits>
 #include <memory>
+#include <utility>
 
 #include "G4DecayTable.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4LogicalVolume.hh"
 #include "G4RunManager.hh"
@@ -26,18 +30,24 @@
 #include "TMath.h"
 #include "TString.h"
 
+#include "core/messenger/BufferPool.hpp"
 #include "core/utils/log.h"
 #include "tools/ROOT.h"
 #include "tools/geant4.h"
 
+#include "DepositionGeant4Module.hpp"
+
 using namespace allpix;
 
-SensitiveDetectorActionG4::SensitiveDetectorActionG4(Module* module,
+SensitiveDetectorActionG4::SensitiveDetectorActionG4(DepositionGeant4Module* module,
                                                      const std::shared_ptr<Detector>& detector,
-                                                     Messenger* msg,
-                                                     double charge_creation_energy)
+                                                     size_t sensor_index,
+                                                     double charge_creation_energy,
+                                                     double merge_length,
+                                                     unsigned int merge_charge)
     : G4VSensitiveDetector("SensitiveDetector_" + detector->getName()), module_(module), detector_(detector),
-      messenger_(msg), charge_creation_energy_(charge_creation_energy) {
+      sensor_index_(sensor_index), charge_creation_energy_(charge_creation_energy), merge_length_(merge_length),
+      merge_charge_(merge_charge), merge_deposits_(merge_length > 0 || merge_charge > 0) {
 
     // Add the sensor to the internal sensitive detector manager
     G4SDManager* sd_man_g4 = G4SDManager::GetSDMpointer();
@@ -59,111 +69,132 @@ G4bool SensitiveDetectorActionG4::ProcessHits(G4Step* step, G4TouchableHistory*)
     auto charge = static_cast<unsigned int>(edep / charge_creation_energy_);
 
     // Save begin point when track is seen for the first time
-    if(track_begin_.find(step->GetTrack()->GetTrackID()) == track_begin_.end()) {
+    auto track = step->GetTrack();
+    auto track_id = track->GetTrackID();
+    auto track_info = tracks_.find(track_id);
+    if(track_info == nullptr) {
         auto start_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(preStepPoint->GetPosition()));
-        track_begin_.emplace(step->GetTrack()->GetTrackID(), start_position);
-
-        track_parents_.emplace(step->GetTrack()->GetTrackID(), step->GetTrack()->GetParentID());
-        track_pdg_.emplace(step->GetTrack()->GetTrackID(), step->GetTrack()->GetDynamicParticle()->GetPDGcode());
+        track_info =
+            &tracks_.insert(track_id, track->GetParentID(), track->GetDynamicParticle()->GetPDGcode(), start_position);
     }
 
     // Update current end point with the current last step
-    auto end_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(postStepPoint->GetPosition()));
-    track_end_[step->GetTrack()->GetTrackID()] = end_position;
+    track_info->end = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(postStepPoint->GetPosition()));
 
     // Add new deposit if the charge is more than zero
     if(charge == 0) {
         return false;
     }
 
-    auto global_deposit_position = detector_->getGlobalPosition(deposit_position);
+    // Add the deposit directly if deposits are not merged
+    if(!merge_deposits_) {
+        add_deposit(deposit_position, charge, mid_time, track_id);
+        return true;
+    }
+
+    // Close the current segment if the step belongs to another track, enters the sensor through a boundary of the geometry
+    // or exceeds the limits of the segment
+    if(segment_charge_ != 0 &&
+       (segment_track_id_ != track_id || preStepPoint->GetStepStatus() == fGeomBoundary ||
+        (merge_charge_ != 0 && segment_charge_ + charge > merge_charge_) ||
+        (merge_length_ > 0 && (deposit_position - segment_start_).R() > merge_length_))) {
+        close_segment();
+    }
+    if(segment_charge_ == 0) {
+        segment_track_id_ = track_id;
+        segment_start_ = deposit_position;
+    }
+
+    // Add the step to the segment, weighting its position and time with its charge
+    segment_charge_ += charge;
+    segment_position_sum_ += static_cast<double>(charge) * (deposit_position - ROOT::Math::XYZPoint());
+    segment_time_sum_ += static_cast<double>(charge) * mid_time;
+
+    return true;
+}
+
+void SensitiveDetectorActionG4::add_deposit(const ROOT::Math::XYZPoint& local_position,
+                                            unsigned int charge,
+                                            double time,
+                                            int track_id) {
+    auto global_position = detector_->getGlobalPosition(local_position);
 
     // Deposit electron
-    deposits_.emplace_back(deposit_position, global_deposit_position, CarrierType::ELECTRON, charge, mid_time);
-    deposit_to_id_.push_back(step->GetTrack()->GetTrackID());
+    deposits_.emplace_back(local_position, global_position, CarrierType::ELECTRON, charge, time);
+    deposit_to_id_.push_back(track_id);
 
     // Deposit hole
-    deposits_.emplace_back(deposit_position, global_deposit_position, CarrierType::HOLE, charge, mid_time);
-    deposit_to_id_.push_back(step->GetTrack()->GetTrackID());
-
-    LOG(DEBUG) << "Created deposit of " << charge << " charges at " << display_vector(mid_pos, {"mm", "um"})
-               << " locally on " << display_vector(deposit_position, {"mm", "um"}) << " in " << detector_->getName()
-               << " after " << Units::display(mid_time, {"ns", "ps"});
+    deposits_.emplace_back(local_position, global_position, CarrierType::HOLE, charge, time);
+    deposit_to_id_.push_back(track_id);
 
-    return true;
+    LOG(DEBUG) << "Created deposit of " << charge << " charges at " << display_vector(global_position, {"mm", "um"})
+               << " locally on " << display_vector(local_position, {"mm", "um"}) << " in " << detector_->getName()
+               << " after " << Units::display(time, {"ns", "ps"});
 }
 
-unsigned int SensitiveDetectorActionG4::getTotalDepositedCharge() {
-    return total_deposited_charge_;
+/**
+ * The merged deposit is placed at the charge-weighted mean position and time of the steps in the segment, and contains the
+ * sum of their charges. All steps of a segment belong to the same track, thus the link to the MCParticle is preserved.
+ */
+void SensitiveDetectorActionG4::close_segment() {
+    if(segment_charge_ == 0) {
+        return;
+    }
+
+    auto charge = static_cast<double>(segment_charge_);
+    add_deposit(ROOT::Math::XYZPoint() + segment_position_sum_ / charge,
+                segment_charge_,
+                segment_time_sum_ / charge,
+                segment_track_id_);
+
+    segment_charge_ = 0;
+    segment_position_sum_ = ROOT::Math::XYZVector();
+    segment_time_sum_ = 0;
 }
 
-void SensitiveDetectorActionG4::dispatchMessages() {
-    // Create the mc particles
-    std::vector<MCParticle> mc_particles;
-    for(auto& track_id_point : track_begin_) {
-        auto track_id = track_id_point.first;
-        auto local_begin = track_id_point.second;
-
-        ROOT::Math::XYZPoint end_point;
-        auto local_end = track_end_.at(track_id);
-        auto pdg_code = track_pdg_.at(track_id);
-
-        auto global_begin = detector_->getGlobalPosition(local_begin);
-        auto global_end = detector_->getGlobalPosition(local_end);
-        mc_particles.emplace_back(local_begin, global_begin, local_end, global_end, pdg_code);
-        id_to_particle_[track_id] = mc_particles.size() - 1;
+/**
+ * Called by Geant4 at the end of every event in the thread that processed the event. The references between the objects are
+ * stored as indices, the module sets them when it dispatches the messages.
+ */
+void SensitiveDetectorActionG4::EndOfEvent(G4HCofThisEvent*) {
+    // Add the deposit of the last segment
+    close_segment();
+
+    SensorHits hits;
+
+    // Create the mc particles in the order of their track id
+    auto& tracks = tracks_.sort();
+    hits.particles = BufferPool::acquire<MCParticle>();
+    hits.particles.reserve(tracks.size());
+    for(auto& track : tracks) {
+        auto global_begin = detector_->getGlobalPosition(track.begin);
+        auto global_end = detector_->getGlobalPosition(track.end);
+        hits.particles.emplace_back(track.begin, global_begin, track.end, global_end, track.pdg_code);
     }
 
     // Link mc particles to parents
-    for(auto& track_parent : track_parents_) {
-        auto track_id = track_parent.first;
-        auto parent_id = track_parent.second;
-        if(id_to_particle_.find(parent_id) == id_to_particle_.end()) {
-            // Skip tracks without direct parents with deposits
-            // FIXME: Geant4 does not allow for an easy way retrieve the whole hierarchy
-            continue;
-        }
-        auto track_idx = id_to_particle_.at(track_id);
-        auto parent_idx = id_to_particle_.at(parent_id);
-        mc_particles.at(track_idx).setParent(&mc_particles.at(parent_idx));
+    // NOTE Tracks without direct parents with deposits are skipped, because Geant4 does not allow for an easy way to
+    // retrieve the whole hierarchy
+    hits.particle_parents = BufferPool::acquire<size_t>();
+    hits.particle_parents.reserve(tracks.size());
+    for(auto& track : tracks) {
+        hits.particle_parents.push_back(tracks_.getParentIndex(track));
     }
 
-    // Send the mc particle information
-    auto mc_particle_message = std::make_shared<MCParticleMessage>(std::move(mc_particles), detector_);
-    messenger_->dispatchMessage(module_, mc_particle_message);
-
-    // Clear track data for the next event
-    track_parents_.clear();
-    track_begin_.clear();
-    track_end_.clear();
-    track_pdg_.clear();
-
-    // Send a deposit message if we have any deposits
-    if(!deposits_.empty()) {
-        unsigned int charges = 0;
-        for(auto& ch : deposits_) {
-            charges += ch.getCharge();
-            total_deposited_charge_ += ch.getCharge();
-        }
-        LOG(INFO) << "Deposited " << charges << " charges in sensor of detector " << detector_->getName();
-
-        // Match deposit with mc particle if possible
-        for(size_t i = 0; i < deposits_.size(); ++i) {
-            auto track_id = deposit_to_id_.at(i);
-            deposits_.at(i).setMCParticle(&mc_particle_message->getData().at(id_to_particle_.at(track_id)));
-        }
-
-        // Create a new charge deposit message
-        auto deposit_message = std::make_shared<DepositedChargeMessage>(std::move(deposits_), detector_);
-
-        // Dispatch the message
-        messenger_->dispatchMessage(module_, deposit_message);
+    // Match deposit with mc particle
+    hits.deposit_particles = BufferPool::acquire<size_t>();
+    hits.deposit_particles.reserve(deposit_to_id_.size());
+    for(auto track_id : deposit_to_id_) {
+        hits.deposit_particles.push_back(tracks_.getIndex(track_id));
     }
 
-    // Clear deposits for next event
-    deposits_ = std::vector<DepositedCharge>();
+    // Hand the deposits to the module, reusing the memory of an earlier event for the next event
+    hits.deposits = std::move(deposits_);
+    deposits_ = BufferPool::acquire<DepositedCharge>();
+    auto event_id = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+    module_->storeHits(event_id, sensor_index_, std::move(hits));
 
-    // Clear link tables for next event
+    // Clear track data for the next event
+    tracks_.clear();
     deposit_to_id_.clear();
-    id_to_particle_.clear();
 }
@@ -11,19 +11,43 @@
 #define ALLPIX_SIMPLE_DEPOSITION_MODULE_SENSITIVE_DETECTOR_ACTION_H
 
 #include <memory>
+#include <vector>
 
 #include <G4VSensitiveDetector.hh>
 #include <G4WrapperProcess.hh>
 
 #include "core/geometry/Detector.hpp"
-#include "core/messenger/Messenger.hpp"
 
 #include "objects/DepositedCharge.hpp"
 #include "objects/MCParticle.hpp"
 
+#include "tools/track_table.h"
+
 namespace allpix {
+    class DepositionGeant4Module;
+
+    /**
+     * @brief Deposits and particles created in a single sensor by one Geant4 event
+     *
+     * Particles are linked to their parent and deposits to their particle by index. The references between the objects are
+     * only set when the messages are dispatched, because they cannot be created safely in the threads of Geant4.
+     */
+    struct SensorHits {
+        // Particles passing the sensor
+        std::vector<MCParticle> particles;
+        // Index of the parent of every particle (or the maximum index if the parent has no deposits)
+        std::vector<size_t> particle_parents;
+        // Deposited charges in the sensor
+        std::vector<DepositedCharge> deposits;
+        // Index of the particle of every deposit
+        std::vector<size_t> deposit_particles;
+    };
+
     /**
      * @brief Handles the steps of the particles in all sensitive devices
+     *
+     * Every thread of Geant4 has its own instance for every sensor. The hits of an event are passed to the module at the
+     * end of every Geant4 event.
      */
     class SensitiveDetectorActionG4 : public G4VSensitiveDetector {
     public:
@@ -31,18 +55,18 @@ namespace allpix {
          * @brief Constructs the action handling for every sensitive detector
          * @param module Pointer to the DepositionGeant4 module holding this class
          * @param detector Detector this sensitive device is bound to
-         * @param msg Pointer to the messenger to send the charge deposits
+         * @param sensor_index Index of the sensor in the list of sensors of the module
          * @param charge_creation_energy Energy needed per deposited charge
+         * @param merge_length Maximum distance between merged deposits of a track (or zero if not limited)
+         * @param merge_charge Maximum charge of a merged deposit (or zero if not limited)
+         * @note Deposits are only merged if at least one of the limits is set
          */
-        SensitiveDetectorActionG4(Module* module,
+        SensitiveDetectorActionG4(DepositionGeant4Module* module,
                                   const std::shared_ptr<Detector>& detector,
-                                  Messenger* msg,
-                                  double charge_creation_energy);
-
-        /**
-         * @brief Get total of charges deposited in the sensitive device bound to this action
-         */
-        unsigned int getTotalDepositedCharge();
+                                  size_t sensor_index,
+                                  double charge_creation_energy,
+                                  double merge_length,
+                                  unsigned int merge_charge);
 
         /**
          * @brief Process a single step of a particle passage through this sensor
@@ -52,37 +76,53 @@ namespace allpix {
         G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
 
         /**
-         * @brief Send the MCParticle and DepositedCharge messages
+         * @brief Pass the MCParticles and DepositedCharges of the finished Geant4 event to the module
+         * @param hce Parameter not used
          */
-        void dispatchMessages();
+        void EndOfEvent(G4HCofThisEvent* hce) override;
 
     private:
+        /**
+         * @brief Add an electron and a hole deposit
+         * @param local_position Position of the deposit in the local frame of the detector
+         * @param charge Number of deposited charges of both types
+         * @param time Time of the deposit
+         * @param track_id Identifier of the track causing the deposit
+         */
+        void add_deposit(const ROOT::Math::XYZPoint& local_position, unsigned int charge, double time, int track_id);
+
+        /**
+         * @brief Add the deposit merged from the steps of the current segment and start a new segment
+         */
+        void close_segment();
+
         // Instantatiation of the deposition module
-        Module* module_;
+        DepositionGeant4Module* module_;
         std::shared_ptr<Detector> detector_;
-        Messenger* messenger_;
+        size_t sensor_index_;
 
         double charge_creation_energy_;
 
-        // Statistics of total deposited charge
-        unsigned int total_deposited_charge_{};
+        // Limits for merging consecutive deposits of a track (zero if not limited)
+        double merge_length_;
+        unsigned int merge_charge_;
+        bool merge_deposits_;
+
+        // Current segment of a track, merging the deposits of consecutive steps
+        int segment_track_id_{};
+        unsigned int segment_charge_{};
+        ROOT::Math::XYZPoint segment_start_;
+        ROOT::Math::XYZVector segment_position_sum_;
+        double segment_time_sum_{};
 
         // Set of deposited charges in this event
         std::vector<DepositedCharge> deposits_;
 
-        // List of begin points for tracks
-        std::map<int, ROOT::Math::XYZPoint> track_begin_;
-        // List of end points for tracks
-        std::map<int, ROOT::Math::XYZPoint> track_end_;
-        // Parent of all mc tracks
-        std::map<int, int> track_parents_;
-        // PDG code of the tracks
-        std::map<int, int> track_pdg_;
+        // Tracks passing the sensor in this event
+        TrackTable<ROOT::Math::XYZPoint> tracks_;
 
         // Map from deposit index to track id
         std::vector<int> deposit_to_id_;
-        // Map from track id to mc particle index
-        std::map<int, size_t> id_to_particle_;
     };
 } // namespace allpix
 
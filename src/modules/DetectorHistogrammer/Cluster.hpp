@@ -67,7 +67,7 @@ namespace allpix {
          * @brief Get the PixelHits contained in this cluster
          * @return List of all contained PixelHits
          */
-        std::set<const PixelHit*> getPixelHits() const { return pixelHits_; }
+        const std::set<const PixelHit*>& getPixelHits() const { return pixelHits_; }
 
         /**
          * @brief Add all pixels from another cluster and delete it
@@ -124,30 +124,28 @@ void DetectorHistogrammerModule::run(unsigned int) {
     }
 
     // Perform a clustering
-    doClustering();
+    auto clusters = doClustering();
 
     // Evaluate the clusters
-    for(auto clus : clusters_) {
-        LOG(DEBUG) << "Cluster, size " << clus->getClusterSize() << " :";
-        for(auto& pixel : clus->getPixelHits()) {
+    for(auto& clus : clusters) {
+        LOG(DEBUG) << "Cluster, size " << clus.getClusterSize() << " :";
+        for(auto& pixel : clus.getPixelHits()) {
             LOG(DEBUG) << pixel->getPixel().getIndex();
         }
         // Fill cluster histograms
-        cluster_size->Fill(static_cast<double>(clus->getClusterSize()));
-        auto clusSizesXY = clus->getClusterSizeXY();
+        cluster_size->Fill(static_cast<double>(clus.getClusterSize()));
+        auto clusSizesXY = clus.getClusterSizeXY();
         cluster_size_x->Fill(clusSizesXY.first);
         cluster_size_y->Fill(clusSizesXY.second);
 
-        auto clusPos = clus->getClusterPosition();
+        auto clusPos = clus.getClusterPosition();
         cluster_map->Fill(clusPos.x(), clusPos.y());
-        cluster_charge->Fill(clus->getClusterCharge() * 1.e-3);
+        cluster_charge->Fill(clus.getClusterCharge() * 1.e-3);
     }
 
     // Fill further histograms
     event_size->Fill(static_cast<double>(pixels_message_->getData().size()));
-    n_cluster->Fill(static_cast<double>(clusters_.size()));
-
-    clusters_.clear();
+    n_cluster->Fill(static_cast<double>(clusters.size()));
 }
 
 void DetectorHistogrammerModule::finalize() {
@@ -234,53 +232,32 @@ void DetectorHistogrammerModule::finalize() {
     cluster_charge->Write();
 }
 
-void DetectorHistogrammerModule::doClustering() {
-
-    for(auto& pixel_hit : pixels_message_->getData()) {
-        Cluster* clus;
-        if(checkAdjacentPixels(&pixel_hit) == 0) {
-            LOG(DEBUG) << "Creating new cluster: " << pixel_hit.getPixel().getIndex();
-            clus = new Cluster(&pixel_hit);
-            clusters_.push_back(clus);
-        }
+/**
+ * Pixel hits in adjacent pixels, including diagonally adjacent pixels, are grouped into the same cluster. The seed of every
+ * cluster is its first pixel hit in the message.
+ */
+std::vector<Cluster> DetectorHistogrammerModule::doClustering() {
+    auto& pixel_hits = pixels_message_->getData();
+
+    // Group the indices of the hit pixels
+    hit_indices_.clear();
+    for(auto& pixel_hit : pixel_hits) {
+        auto hit_idx = pixel_hit.getPixel().getIndex();
+        hit_indices_.emplace_back(hit_idx.x(), hit_idx.y());
     }
-}
-
-unsigned int DetectorHistogrammerModule::checkAdjacentPixels(const PixelHit* pixel_hit) {
-    auto hit_idx = pixel_hit->getPixel().getIndex();
-    unsigned int adjacentClusters = 0;
-    if(clusters_.empty()) {
-        LOG(DEBUG) << "No clusters to check.";
-    } else {
-        LOG(DEBUG) << "Check for clusters with adjacent pixels to " << hit_idx;
-        Cluster* firstFoundCluster = clusters_.front();
-        for(auto it = clusters_.begin(); it < clusters_.end();) {
-            bool mergedCluster = false;
-            Cluster* clus = *it;
-            for(auto& pixel_other : clus->getPixelHits()) {
-                auto other_idx = pixel_other->getPixel().getIndex();
-                auto distx = std::max(hit_idx.x(), other_idx.x()) - std::min(hit_idx.x(), other_idx.x());
-                auto disty = std::max(hit_idx.y(), other_idx.y()) - std::min(hit_idx.y(), other_idx.y());
-                if(distx <= 1 and disty <= 1) {
-                    adjacentClusters++;
-                    if(adjacentClusters == 1) {
-                        LOG(DEBUG) << "Found first adjacent cluster (with pixel " << other_idx << "). Add pixel.";
-                        clus->addPixelHit(pixel_hit);
-                        firstFoundCluster = clus;
-                    } else if(adjacentClusters == 2) {
-                        LOG(DEBUG) << "Found another adjacent cluster. Merging clusters.";
-                        firstFoundCluster->eatCluster(clus);
-                        adjacentClusters--;
-                        it = clusters_.erase(it);
-                        mergedCluster = true;
-                    }
-                    break;
-                }
-            }
-            if(!mergedCluster) {
-                ++it;
-            }
+    auto clusters_count = cluster_finder_.find(hit_indices_);
+    auto& labels = cluster_finder_.getLabels();
+
+    // Create the clusters from their seed and add the other pixel hits
+    std::vector<Cluster> clusters;
+    clusters.reserve(clusters_count);
+    for(size_t i = 0; i < pixel_hits.size(); ++i) {
+        if(labels[i] == clusters.size()) {
+            LOG(DEBUG) << "Creating new cluster: " << pixel_hits[i].getPixel().getIndex();
+            clusters.emplace_back(&pixel_hits[i]);
+        } else {
+            clusters[labels[i]].addPixelHit(&pixel_hits[i]);
         }
     }
-    return adjacentClusters;
+    return clusters;
 }
@@ -25,6 +25,7 @@
 
 #include "Cluster.hpp"
 #include "objects/PixelHit.hpp"
+#include "tools/clustering.h"
 
 namespace allpix {
     /**
@@ -60,14 +61,9 @@ namespace allpix {
 
         /**
          * @brief Perform a sparse clustering on the PixelHits
+         * @return List of clusters in the order of their seed pixel hit
          */
-        void doClustering();
-
-        /**
-         * @brief Checks the adjacent pixels for PixelHits
-         * @param pixel_hit Hit to check
-         */
-        unsigned int checkAdjacentPixels(const PixelHit*);
+        std::vector<Cluster> doClustering();
 
     private:
         Configuration config_;
@@ -81,7 +77,8 @@ namespace allpix {
         unsigned long total_hits_{};
 
         // Forming clusters
-        std::vector<Cluster*> clusters_;
+        PixelClusterFinder cluster_finder_;
+        std::vector<std::pair<unsigned int, unsigned int>> hit_indices_;
 
         // Histograms to output
         TH2I* hit_map;
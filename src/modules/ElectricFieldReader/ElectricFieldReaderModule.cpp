@@ -9,6 +9,10 @@
 
 #include "ElectricFieldReaderModule.hpp"
 
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <limits>
 #include <memory>
@@ -17,6 +21,11 @@
 #include <string>
 #include <utility>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <Math/Vector3D.h>
 #include <TH2F.h>
 
@@ -55,9 +64,8 @@ void ElectricFieldReaderModule::init() {
 
     // Calculate the field depending on the configuration
     if(field_model == "init") {
-        ElectricFieldReaderModule::FieldData field_data;
-        field_data = read_init_field();
-        detector_->setElectricFieldGrid(field_data.first, field_data.second, thickness_domain);
+        auto grid = read_init_field(thickness_domain);
+        detector_->setElectricFieldGrid(grid);
     } else if(field_model == "constant") {
         LOG(TRACE) << "Adding constant electric field";
         type = ElectricFieldType::CONSTANT;
@@ -113,17 +121,22 @@ ElectricFieldFunction ElectricFieldReaderModule::get_linear_field_function(std::
  * The field read from the INIT format are shared between module instantiations using the static
  * ElectricFieldReaderModuleget_by_file_name method.
  */
-ElectricFieldReaderModule::FieldData ElectricFieldReaderModule::read_init_field() {
+std::shared_ptr<ElectricFieldGrid>
+ElectricFieldReaderModule::read_init_field(std::pair<double, double> thickness_domain) {
     try {
         LOG(TRACE) << "Fetching electric field from init file";
 
         // Get field from file
-        auto field_data = get_by_file_name(config_.getPath("file_name", true), *detector_.get());
-        LOG(INFO) << "Set electric field with " << field_data.second.at(0) << "x" << field_data.second.at(1) << "x"
-                  << field_data.second.at(2) << " cells";
-
-        // Return the field data
-        return field_data;
+        auto grid = get_by_file_name(config_.getPath("file_name", true),
+                                     *detector_.get(),
+                                     config_.get<bool>("binary_cache", true),
+                                     thickness_domain,
+                                     config_.get<bool>("interpolate_field", false));
+        auto sizes = grid->getSizes();
+        LOG(INFO) << "Set electric field with " << sizes.at(0) << "x" << sizes.at(1) << "x" << sizes.at(2) << " cells";
+
+        // Return the field grid
+        return grid;
     } catch(std::invalid_argument& e) {
         throw InvalidValueError(config_, "file_name", e.what());
     } catch(std::runtime_error& e) {
@@ -278,16 +291,114 @@ inline static void check_detector_match(Detector& detector, double thickness, do
     }
 }
 
-std::map<std::string, ElectricFieldReaderModule::FieldData> ElectricFieldReaderModule::field_map_;
-ElectricFieldReaderModule::FieldData ElectricFieldReaderModule::get_by_file_name(const std::string& file_name,
-                                                                                 Detector& detector) {
+/**
+ * @brief Header of the binary field format
+ *
+ * The header is followed directly by the field vectors, either in the flat layout used by
+ * \ref Detector::setElectricFieldGrid (a tile size of zero) or in the tiled layout of \ref ElectricFieldGrid. The values
+ * are the field in the field unit multiplied by the field unit value. Binary copies written by the module use the value of
+ * the field unit in the framework units, such that the stored values are in the framework units. The checksum covers the
+ * data.
+ */
+struct BinaryFieldHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t sizes[3];
+    uint64_t tile_size;
+    double thickness;
+    double pixel_size[2];
+    char length_unit[8];
+    char field_unit[8];
+    double field_unit_value;
+    uint64_t checksum;
+};
+static_assert(sizeof(BinaryFieldHeader) % alignof(double) == 0, "field data after the header has to be aligned");
+static const char binary_field_magic[8] = {'A', 'P', 'S', 'Q', 'F', 'I', 'E', 'L'};
+static const uint32_t binary_field_version = 2;
+static const uint32_t binary_field_byte_order = 0x01020304;
+
+/**
+ * @brief Compute the checksum of the field data (FNV-1a over 64 bit words)
+ */
+inline static uint64_t field_checksum(const char* data, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(size_t i = 0; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(uint64_t));
+        hash = (hash ^ word) * 0x100000001b3;
+    }
+    return hash;
+}
+
+std::map<std::string, std::vector<std::shared_ptr<ElectricFieldGrid>>> ElectricFieldReaderModule::field_map_;
+
+/**
+ * Files in the binary format are recognized by their header and read directly. For a file in the INIT format, a binary
+ * copy with the suffix ".bin" is read instead if it exists, is newer than the INIT file and is valid. Otherwise the INIT
+ * file is parsed and the binary copy is written for the next time the field is loaded.
+ *
+ * Only the tiled field vectors of the grid are kept after reading a file, which for binary files in the tiled layout and
+ * the framework units are the mapping of the file itself. Detectors with the same pixel geometry share the same grid,
+ * detectors with another pixel geometry get a grid sharing the field vectors of the cached grids.
+ */
+std::shared_ptr<ElectricFieldGrid> ElectricFieldReaderModule::get_by_file_name(const std::string& file_name,
+                                                                               Detector& detector,
+                                                                               bool binary_cache,
+                                                                               std::pair<double, double> thickness_domain,
+                                                                               bool interpolate) {
+    auto pixel_size = detector.getModel()->getPixelSize();
+
     // Search in cache (NOTE: the path reached here is always a canonical name)
     auto iter = field_map_.find(file_name);
     if(iter != field_map_.end()) {
         // FIXME Check detector match here as well
-        return iter->second;
+        auto& grids = iter->second;
+        for(auto& grid : grids) {
+            if(grid->getPixelSize() == pixel_size && grid->getThicknessDomain() == thickness_domain &&
+               grid->isInterpolated() == interpolate) {
+                return grid;
+            }
+        }
+        grids.push_back(std::make_shared<ElectricFieldGrid>(*grids.front(), pixel_size, thickness_domain, interpolate));
+        return grids.back();
+    }
+
+    // Check if the file itself is in the binary format
+    char magic[sizeof(binary_field_magic)] = {};
+    std::ifstream(file_name, std::ios::binary).read(magic, sizeof(magic));
+    FieldData field_data;
+    if(std::memcmp(magic, binary_field_magic, sizeof(magic)) == 0) {
+        field_data = read_binary_file(file_name, detector);
+    } else if(binary_cache) {
+        // Use the binary copy of the INIT file if it is up to date
+        auto binary_name = file_name + ".bin";
+        struct stat init_stat, binary_stat;
+        if(stat(file_name.c_str(), &init_stat) == 0 && stat(binary_name.c_str(), &binary_stat) == 0 &&
+           binary_stat.st_mtime >= init_stat.st_mtime) {
+            try {
+                field_data = read_binary_file(binary_name, detector);
+                LOG(DEBUG) << "Read electric field from binary copy " << binary_name;
+            } catch(std::runtime_error& e) {
+                LOG(WARNING) << "Ignoring binary copy " << binary_name << " of electric field: " << e.what();
+            }
+        }
+        if(field_data.first == nullptr) {
+            field_data = read_init_file(file_name, detector, binary_name);
+        }
+    } else {
+        field_data = read_init_file(file_name, detector, "");
     }
 
+    // Build the grid directly on the tiled field vectors
+    auto grid =
+        std::make_shared<ElectricFieldGrid>(field_data.first, field_data.second, pixel_size, thickness_domain, interpolate);
+    field_map_[file_name].push_back(grid);
+    return grid;
+}
+
+ElectricFieldReaderModule::FieldData
+ElectricFieldReaderModule::read_init_file(const std::string& file_name, Detector& detector, const std::string& binary_name) {
     // Load file
     std::ifstream file(file_name);
 
@@ -303,16 +414,13 @@ ElectricFieldReaderModule::FieldData ElectricFieldReaderModule::get_by_file_name
     file >> tmp >> tmp >> tmp; // ignore the magnetic field (specify separately)
     double thickness, xpixsz, ypixsz;
     file >> thickness >> xpixsz >> ypixsz;
-    thickness = Units::get(thickness, "um");
-    xpixsz = Units::get(xpixsz, "um");
-    ypixsz = Units::get(ypixsz, "um");
     file >> tmp >> tmp >> tmp >> tmp; // ignore temperature, flux, rhe (?) and new_drde (?)
     size_t xsize, ysize, zsize;
     file >> xsize >> ysize >> zsize;
     file >> tmp;
 
     // Check if electric field matches chip
-    check_detector_match(detector, thickness, xpixsz, ypixsz);
+    check_detector_match(detector, Units::get(thickness, "um"), Units::get(xpixsz, "um"), Units::get(ypixsz, "um"));
 
     if(file.fail()) {
         throw std::runtime_error("invalid data or unexpected end of file");
@@ -343,9 +451,156 @@ ElectricFieldReaderModule::FieldData ElectricFieldReaderModule::get_by_file_name
             file >> input;
 
             // Set the electric field at a position
-            (*field)[xind * ysize * zsize * 3 + yind * zsize * 3 + zind * 3 + j] = Units::get(input, "V/cm");
+            (*field)[xind * ysize * zsize * 3 + yind * zsize * 3 + zind * 3 + j] = input;
+        }
+    }
+    std::array<size_t, 3> sizes{{xsize, ysize, zsize}};
+
+    // Convert the field to the framework units and into the tiled layout
+    auto unit = Units::get("V/cm");
+    for(auto& value : *field) {
+        value = static_cast<double>(value * unit);
+    }
+    auto tiled_field = std::make_shared<const std::vector<double>>(ElectricFieldGrid::tile(*field, sizes));
+    field.reset();
+
+    // Write the binary copy of the field if requested
+    if(!binary_name.empty()) {
+        try {
+            write_binary_file(binary_name, *tiled_field, sizes, thickness, xpixsz, ypixsz);
+            LOG(INFO) << "Written binary copy of electric field to " << binary_name;
+        } catch(std::runtime_error& e) {
+            LOG(WARNING) << "Cannot write binary copy of electric field: " << e.what();
         }
     }
 
-    return std::make_pair(field, std::array<size_t, 3>{{xsize, ysize, zsize}});
+    return std::make_pair(std::shared_ptr<const double>(tiled_field, tiled_field->data()), sizes);
+}
+
+/**
+ * @throws std::runtime_error If the file cannot be mapped or is not a valid binary field file
+ *
+ * The file is mapped read-only into memory, such that the field data is shared through the page cache between all processes
+ * reading the same file. If the file is stored in the tiled layout and in the framework units, the grid reads the field
+ * directly from the mapping, which stays mapped as long as the grid exists. Otherwise the field is copied from the mapping,
+ * converted to the framework units and tiled. Binary files are always replaced by renaming, never modified in place, such
+ * that a mapped file does not change.
+ */
+ElectricFieldReaderModule::FieldData ElectricFieldReaderModule::read_binary_file(const std::string& file_name,
+                                                                                 Detector& detector) {
+    // Map the file into memory
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if(fd == -1) {
+        throw std::runtime_error("cannot open file (" + std::string(std::strerror(errno)) + ")");
+    }
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) == -1) {
+        close(fd);
+        throw std::runtime_error("cannot access file (" + std::string(std::strerror(errno)) + ")");
+    }
+    auto length = static_cast<size_t>(file_stat.st_size);
+    void* mapping = (length == 0 ? MAP_FAILED : mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0));
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        throw std::runtime_error("cannot map file into memory");
+    }
+    std::shared_ptr<void> mapping_guard(mapping, [length](void* ptr) { munmap(ptr, length); });
+    const char* data = static_cast<const char*>(mapping);
+
+    // Read and check the header
+    if(length < sizeof(BinaryFieldHeader)) {
+        throw std::runtime_error("file too small to contain a binary field header");
+    }
+    BinaryFieldHeader header;
+    std::memcpy(&header, data, sizeof(BinaryFieldHeader));
+    if(std::memcmp(header.magic, binary_field_magic, sizeof(binary_field_magic)) != 0) {
+        throw std::runtime_error("file is not in the binary field format");
+    }
+    if(header.version != binary_field_version || header.byte_order != binary_field_byte_order) {
+        throw std::runtime_error("unsupported version or byte order of binary field format");
+    }
+    if(header.tile_size != 0 && header.tile_size != ElectricFieldGrid::tile_size) {
+        throw std::runtime_error("unsupported tile size " + std::to_string(header.tile_size) + " of binary field format");
+    }
+    header.length_unit[sizeof(header.length_unit) - 1] = '\0';
+    header.field_unit[sizeof(header.field_unit) - 1] = '\0';
+
+    // Check the size and the checksum of the field data
+    std::array<size_t, 3> sizes{};
+    for(size_t i = 0; i < 3; ++i) {
+        sizes[i] = header.sizes[i];
+    }
+    auto values = (header.tile_size == 0 ? sizes[0] * sizes[1] * sizes[2] * 3 : ElectricFieldGrid::getTiledLength(sizes));
+    if(length != sizeof(BinaryFieldHeader) + values * sizeof(double)) {
+        throw std::runtime_error("size of file does not match the field dimensions");
+    }
+    if(field_checksum(data + sizeof(BinaryFieldHeader), length - sizeof(BinaryFieldHeader)) != header.checksum) {
+        throw std::runtime_error("checksum of field data does not match");
+    }
+
+    // Check if electric field matches chip
+    check_detector_match(detector,
+                         Units::get(header.thickness, header.length_unit),
+                         Units::get(header.pixel_size[0], header.length_unit),
+                         Units::get(header.pixel_size[1], header.length_unit));
+
+    // Use the mapping directly if the field is stored in the tiled layout and the framework units
+    auto field_data = reinterpret_cast<const double*>(data + sizeof(BinaryFieldHeader));
+    auto unit = static_cast<double>(Units::get(header.field_unit)) / header.field_unit_value;
+    if(header.tile_size == ElectricFieldGrid::tile_size && unit == 1.0) {
+        LOG(DEBUG) << "Using mapped electric field of binary file " << file_name;
+        return std::make_pair(std::shared_ptr<const double>(mapping_guard, field_data), sizes);
+    }
+
+    // Otherwise copy the field, convert it to the framework units and tile it
+    LOG(DEBUG) << "Copying electric field of binary file " << file_name << " as its units or layout differ";
+    std::vector<double> field(field_data, field_data + values);
+    for(auto& value : field) {
+        value *= unit;
+    }
+    auto tiled_field = std::make_shared<const std::vector<double>>(
+        header.tile_size == 0 ? ElectricFieldGrid::tile(field, sizes) : std::move(field));
+    return std::make_pair(std::shared_ptr<const double>(tiled_field, tiled_field->data()), sizes);
+}
+
+/**
+ * @throws std::runtime_error If the binary file cannot be written
+ *
+ * The field is written in the tiled layout and in the framework units, such that it can be used directly from the mapped
+ * file. The file is first written under a temporary name and then renamed, such that concurrent jobs never read a partially
+ * written file and mapped files are never changed.
+ */
+void ElectricFieldReaderModule::write_binary_file(const std::string& file_name,
+                                                  const std::vector<double>& field,
+                                                  std::array<size_t, 3> sizes,
+                                                  double thickness,
+                                                  double xpixsz,
+                                                  double ypixsz) {
+    // Construct the header
+    BinaryFieldHeader header = {};
+    std::memcpy(header.magic, binary_field_magic, sizeof(binary_field_magic));
+    header.version = binary_field_version;
+    header.byte_order = binary_field_byte_order;
+    for(size_t i = 0; i < 3; ++i) {
+        header.sizes[i] = sizes[i];
+    }
+    header.tile_size = ElectricFieldGrid::tile_size;
+    header.thickness = thickness;
+    header.pixel_size[0] = xpixsz;
+    header.pixel_size[1] = ypixsz;
+    std::strncpy(header.length_unit, "um", sizeof(header.length_unit) - 1);
+    std::strncpy(header.field_unit, "V/cm", sizeof(header.field_unit) - 1);
+    header.field_unit_value = static_cast<double>(Units::get("V/cm"));
+    header.checksum = field_checksum(reinterpret_cast<const char*>(field.data()), field.size() * sizeof(double));
+
+    // Write to a temporary file and move it to the final location
+    auto tmp_file_name = file_name + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream file(tmp_file_name, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryFieldHeader));
+    file.write(reinterpret_cast<const char*>(field.data()), static_cast<std::streamsize>(field.size() * sizeof(double)));
+    file.close();
+    if(file.fail() || std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+        std::remove(tmp_file_name.c_str());
+        throw std::runtime_error("cannot write file " + file_name);
+    }
 }
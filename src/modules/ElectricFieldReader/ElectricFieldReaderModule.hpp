@@ -28,7 +28,8 @@ namespace allpix {
      * - For the INIT format, reads the specified file and add the electric field grid to the bound detectors
      */
     class ElectricFieldReaderModule : public Module {
-        using FieldData = std::pair<std::shared_ptr<std::vector<double>>, std::array<size_t, 3>>;
+        // Tiled field vectors in the framework units and the dimensions of the field
+        using FieldData = std::pair<std::shared_ptr<const double>, std::array<size_t, 3>>;
 
     public:
         /**
@@ -55,9 +56,11 @@ namespace allpix {
         ElectricFieldFunction get_linear_field_function(std::pair<double, double> thickness_domain);
 
         /**
-         * @brief Read field in the init format and apply it
+         * @brief Read field in the init format
+         * @param thickness_domain Domain of the thickness where the field is defined
+         * @return Grid of the field for the pixel geometry of the detector
          */
-        FieldData read_init_field();
+        std::shared_ptr<ElectricFieldGrid> read_init_field(std::pair<double, double> thickness_domain);
 
         /**
          * @brief Create output plots of the electric field profile
@@ -65,9 +68,48 @@ namespace allpix {
         void create_output_plots();
 
         /**
-         * @brief Get the electric field from a file name, caching the result between instantiations
+         * @brief Get the grid of the electric field from a file name, caching the result between instantiations
+         * @param name Canonical path of the file in the INIT or the binary field format
+         * @param detector Detector to check the field for
+         * @param binary_cache True if INIT files should be converted to and read from the binary field format
+         * @param thickness_domain Domain of the thickness where the field is defined
+         * @param interpolate True if the field should be interpolated trilinearly between the grid points
+         * @return Grid of the field, shared with all detectors with the same pixel geometry
+         */
+        static std::shared_ptr<ElectricFieldGrid> get_by_file_name(const std::string& name,
+                                                                   Detector& detector,
+                                                                   bool binary_cache,
+                                                                   std::pair<double, double> thickness_domain,
+                                                                   bool interpolate);
+        /**
+         * @brief Parse a field file in the INIT format
+         * @param name Path of the file in the INIT format
+         * @param detector Detector to check the field for
+         * @param binary_name Path to write the field to in the binary format (empty to not write a binary file)
+         */
+        static FieldData read_init_file(const std::string& name, Detector& detector, const std::string& binary_name);
+        /**
+         * @brief Read a field file in the binary format
+         * @param name Path of the file in the binary format
+         * @param detector Detector to check the field for
+         */
+        static FieldData read_binary_file(const std::string& name, Detector& detector);
+        /**
+         * @brief Write a field to a file in the binary format
+         * @param name Path of the binary file to write
+         * @param field Tiled field vectors in the framework units
+         * @param sizes The dimensions of the electric field
+         * @param thickness Thickness of the sensor in um
+         * @param xpixsz Pixel pitch in x in um
+         * @param ypixsz Pixel pitch in y in um
          */
-        static FieldData get_by_file_name(const std::string& name, Detector&);
-        static std::map<std::string, FieldData> field_map_;
+        static void write_binary_file(const std::string& name,
+                                      const std::vector<double>& field,
+                                      std::array<size_t, 3> sizes,
+                                      double thickness,
+                                      double xpixsz,
+                                      double ypixsz);
+        // Grids of the fields read from every file, which all share the same tiled field vectors
+        static std::map<std::string, std::vector<std::shared_ptr<ElectricFieldGrid>>> field_map_;
     };
 } // namespace allpix
@@ -10,7 +10,9 @@
 
 #include "GenericPropagationModule.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <future>
 #include <limits>
 #include <map>
 #include <memory>
@@ -38,6 +40,7 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "tools/ROOT.h"
+#include "tools/mobility.h"
 #include "tools/runge_kutta.h"
 
 #include "objects/DepositedCharge.hpp"
@@ -46,8 +49,8 @@
 using namespace allpix;
 
 /**
- * Besides binding the message and setting defaults for the configuration, the module copies some configuration variables to
- * local copies to speed up computation.
+ * Besides binding the message and setting defaults for the configuration, the module binds all configuration variables used
+ * during the propagation to local copies to speed up computation.
  */
 GenericPropagationModule::GenericPropagationModule(Configuration config,
                                                    Messenger* messenger,
@@ -62,9 +65,6 @@ GenericPropagationModule::GenericPropagationModule(Configuration config,
     // Require deposits message for single detector
     messenger_->bindSingle(this, &GenericPropagationModule::deposits_message_, MsgFlags::REQUIRED);
 
-    // Seed the random generator with the module seed
-    random_generator_.seed(getRandomSeed());
-
     // Set default value for config variables
     config_.setDefault<double>("spatial_precision", Units::get(0.25, "nm"));
     config_.setDefault<double>("timestep_start", Units::get(0.01, "ns"));
@@ -72,7 +72,10 @@ GenericPropagationModule::GenericPropagationModule(Configuration config,
     config_.setDefault<double>("timestep_max", Units::get(0.5, "ns"));
     config_.setDefault<double>("integration_time", Units::get(25, "ns"));
     config_.setDefault<unsigned int>("charge_per_step", 10);
+    config_.setDefault<unsigned int>("charge_groups_per_task", 100);
+    config_.setDefault<bool>("batched_propagation", false);
     config_.setDefault<double>("temperature", 293.15);
+    config_.setDefault<double>("mobility_accuracy", 1e-4);
 
     config_.setDefault<bool>("output_plots", false);
     config_.setDefault<bool>("output_animations", false);
@@ -82,43 +85,48 @@ GenericPropagationModule::GenericPropagationModule(Configuration config,
     config_.setDefault<bool>("output_plots_align_pixels", false);
     config_.setDefault<double>("output_plots_theta", 0.0f);
     config_.setDefault<double>("output_plots_phi", 0.0f);
+    config_.setDefault<bool>("output_plots_use_equal_scaling", true);
+    config_.setDefault<double>("output_plots_contour_max_scaling", 10);
+    config_.setDefault<double>("output_animations_time_scaling", 1e9);
+    config_.setDefault<unsigned int>("output_animations_marker_size", 1);
 
     // Set defaults for charge carrier propagation:
     config_.setDefault<bool>("propagate_electrons", true);
     config_.setDefault<bool>("propagate_holes", false);
-    if(!config_.get<bool>("propagate_electrons") && !config_.get<bool>("propagate_holes")) {
-        throw InvalidValueError(
-            config_,
-            "propagate_electrons",
-            "No charge carriers selected for propagation, enable 'propagate_electrons' or 'propagate_holes'.");
-    }
-    // Copy some variables from configuration to avoid lookups:
-    temperature_ = config_.get<double>("temperature");
-    timestep_min_ = config_.get<double>("timestep_min");
-    timestep_max_ = config_.get<double>("timestep_max");
-    timestep_start_ = config_.get<double>("timestep_start");
-    integration_time_ = config_.get<double>("integration_time");
-    target_spatial_precision_ = config_.get<double>("spatial_precision");
-    output_plots_ = config_.get<bool>("output_plots");
-    output_plots_step_ = config_.get<double>("output_plots_step");
-
-    // Parameterization variables from https://doi.org/10.1016/0038-1101(77)90054-5 (section 5.2)
-    electron_Vm_ = Units::get(1.53e9 * std::pow(temperature_, -0.87), "cm/s");
-    electron_Ec_ = Units::get(1.01 * std::pow(temperature_, 1.55), "V/cm");
-    electron_Beta_ = 2.57e-2 * std::pow(temperature_, 0.66);
-
-    hole_Vm_ = Units::get(1.62e8 * std::pow(temperature_, -0.52), "cm/s");
-    hole_Ec_ = Units::get(1.24 * std::pow(temperature_, 1.68), "V/cm");
-    hole_Beta_ = 0.46 * std::pow(temperature_, 0.17);
 
-    boltzmann_kT_ = Units::get(8.6173e-5, "eV/K") * temperature_;
+    // Bind the parameters used during the propagation
+    bind_parameter(config_, "temperature", temperature_);
+    bind_parameter(config_, "timestep_min", timestep_min_);
+    bind_parameter(config_, "timestep_max", timestep_max_);
+    bind_parameter(config_, "timestep_start", timestep_start_);
+    bind_parameter(config_, "integration_time", integration_time_);
+    bind_parameter(config_, "spatial_precision", target_spatial_precision_);
+    bind_parameter(config_, "charge_groups_per_task", charge_groups_per_task_);
+    bind_parameter(config_, "batched_propagation", batched_propagation_);
+    bind_parameter(config_, "propagate_electrons", propagate_electrons_);
+    bind_parameter(config_, "propagate_holes", propagate_holes_);
+    bind_parameter(config_, "charge_per_step", charge_per_step_);
+
+    // Bind the parameters of the output plots
+    bind_parameter(config_, "output_plots", output_plots_);
+    bind_parameter(config_, "output_plots_step", output_plots_step_);
+    bind_parameter(config_, "output_plots_theta", output_plots_theta_);
+    bind_parameter(config_, "output_plots_phi", output_plots_phi_);
+    bind_parameter(config_, "output_plots_use_pixel_units", output_plots_use_pixel_units_);
+    bind_parameter(config_, "output_plots_use_equal_scaling", output_plots_use_equal_scaling_);
+    bind_parameter(config_, "output_plots_align_pixels", output_plots_align_pixels_);
+    bind_parameter(config_, "output_plots_contour_max_scaling", output_plots_contour_max_scaling_);
+    bind_parameter(config_, "output_animations", output_animations_);
+    bind_parameter(config_, "output_animations_time_scaling", output_animations_time_scaling_);
+    bind_parameter(config_, "output_animations_marker_size", output_animations_marker_size_);
+    bind_parameter(config_, "output_animations_color_markers", output_animations_color_markers_);
 }
 
 void GenericPropagationModule::create_output_plots(unsigned int event_num) {
     LOG(TRACE) << "Writing output plots";
 
     // Convert to pixel units if necessary
-    if(config_.get<bool>("output_plots_use_pixel_units")) {
+    if(output_plots_use_pixel_units_) {
         for(auto& deposit_points : output_plot_points_) {
             for(auto& point : deposit_points.second) {
                 point.SetX((point.x() / model_->getPixelSize().x()) + 1);
@@ -150,10 +158,10 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
     }
 
     // Compute frame axis sizes if equal scaling is requested
-    if(config_.get<bool>("output_plots_use_equal_scaling", true)) {
+    if(output_plots_use_equal_scaling_) {
         double centerX = (minX + maxX) / 2.0;
         double centerY = (minY + maxY) / 2.0;
-        if(config_.get<bool>("output_plots_use_pixel_units")) {
+        if(output_plots_use_pixel_units_) {
             minX = centerX - model_->getSensorSize().z() / model_->getPixelSize().x() / 2.0;
             maxX = centerX + model_->getSensorSize().z() / model_->getPixelSize().x() / 2.0;
 
@@ -169,8 +177,8 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
     }
 
     // Align on pixels if requested
-    if(config_.get<bool>("output_plots_align_pixels")) {
-        if(config_.get<bool>("output_plots_use_pixel_units")) {
+    if(output_plots_align_pixels_) {
+        if(output_plots_use_pixel_units_) {
             minX = std::floor(minX - 0.5) + 0.5;
             minY = std::floor(minY + 0.5) - 0.5;
             maxX = std::ceil(maxX - 0.5) + 0.5;
@@ -208,14 +216,14 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
                                             1280,
                                             1024);
     canvas->cd();
-    canvas->SetTheta(config_.get<float>("output_plots_theta") * 180.0f / ROOT::Math::Pi());
-    canvas->SetPhi(config_.get<float>("output_plots_phi") * 180.0f / ROOT::Math::Pi());
+    canvas->SetTheta(output_plots_theta_ * 180.0 / ROOT::Math::Pi());
+    canvas->SetPhi(output_plots_phi_ * 180.0 / ROOT::Math::Pi());
 
     // Draw the frame on the canvas
     histogram_frame->GetXaxis()->SetTitle(
-        (std::string("x ") + (config_.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)")).c_str());
+        (std::string("x ") + (output_plots_use_pixel_units_ ? "(pixels)" : "(mm)")).c_str());
     histogram_frame->GetYaxis()->SetTitle(
-        (std::string("y ") + (config_.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)")).c_str());
+        (std::string("y ") + (output_plots_use_pixel_units_ ? "(pixels)" : "(mm)")).c_str());
     histogram_frame->GetZaxis()->SetTitle("z (mm)");
     histogram_frame->Draw();
 
@@ -251,10 +259,10 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
     canvas->cd();
 
     // Change axis labels if close to zero or PI as they behave different here
-    if(std::fabs(config_.get<double>("output_plots_theta") / (ROOT::Math::Pi() / 2.0) -
-                 std::round(config_.get<double>("output_plots_theta") / (ROOT::Math::Pi() / 2.0))) < 1e-6 ||
-       std::fabs(config_.get<double>("output_plots_phi") / (ROOT::Math::Pi() / 2.0) -
-                 std::round(config_.get<double>("output_plots_phi") / (ROOT::Math::Pi() / 2.0))) < 1e-6) {
+    if(std::fabs(output_plots_theta_ / (ROOT::Math::Pi() / 2.0) -
+                 std::round(output_plots_theta_ / (ROOT::Math::Pi() / 2.0))) < 1e-6 ||
+       std::fabs(output_plots_phi_ / (ROOT::Math::Pi() / 2.0) -
+                 std::round(output_plots_phi_ / (ROOT::Math::Pi() / 2.0))) < 1e-6) {
         histogram_frame->GetXaxis()->SetLabelOffset(-0.1f);
         histogram_frame->GetYaxis()->SetLabelOffset(-0.075f);
     } else {
@@ -265,7 +273,7 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
     // Draw frame on canvas
     histogram_frame->Draw();
 
-    if(config_.get<bool>("output_animations")) {
+    if(output_animations_) {
         // Create the contour histogram
         std::vector<std::string> file_name_contour;
         std::vector<TH2F*> histogram_contour;
@@ -324,8 +332,8 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
 
         // Create animation of moving charges
         auto animation_time = static_cast<unsigned int>(
-            std::round((Units::convert(config_.get<long double>("output_plots_step"), "ms") / 10.0) *
-                       config_.get<long double>("output_animations_time_scaling", 1e9)));
+            std::round((Units::convert(output_plots_step_, "ms") / 10.0) *
+                       output_animations_time_scaling_));
         unsigned long plot_idx = 0;
         unsigned int point_cnt = 0;
         LOG_PROGRESS(INFO, getUniqueName() + "_OUTPUT_PLOTS") << "Written 0 of " << tot_point_cnt << " points for animation";
@@ -335,21 +343,21 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
 
             // Reset the canvas
             canvas->Clear();
-            canvas->SetTheta(config_.get<float>("output_plots_theta") * 180.0f / ROOT::Math::Pi());
-            canvas->SetPhi(config_.get<float>("output_plots_phi") * 180.0f / ROOT::Math::Pi());
+            canvas->SetTheta(output_plots_theta_ * 180.0 / ROOT::Math::Pi());
+            canvas->SetPhi(output_plots_phi_ * 180.0 / ROOT::Math::Pi());
             canvas->Draw();
 
             // Reset the histogram frame
             histogram_frame->SetTitle("Charge propagation in sensor");
             histogram_frame->GetXaxis()->SetTitle(
-                (std::string("x ") + (config_.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)")).c_str());
+                (std::string("x ") + (output_plots_use_pixel_units_ ? "(pixels)" : "(mm)")).c_str());
             histogram_frame->GetYaxis()->SetTitle(
-                (std::string("y ") + (config_.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)")).c_str());
+                (std::string("y ") + (output_plots_use_pixel_units_ ? "(pixels)" : "(mm)")).c_str());
             histogram_frame->GetZaxis()->SetTitle("z (mm)");
             histogram_frame->Draw();
 
             auto text = std::make_unique<TPaveText>(-0.75, -0.75, -0.60, -0.65);
-            auto time_ns = Units::convert(plot_idx * config_.get<long double>("output_plots_step"), "ns");
+            auto time_ns = Units::convert(static_cast<double>(plot_idx) * output_plots_step_, "ns");
             std::stringstream sstr;
             sstr << std::fixed << std::setprecision(2) << time_ns << "ns";
             auto time_str = std::string(8 - sstr.str().size(), ' ');
@@ -362,7 +370,7 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
                 auto points = deposit_points.second;
 
                 auto diff = static_cast<unsigned long>(std::round((deposit_points.first.getEventTime() - start_time) /
-                                                                  config_.get<long double>("output_plots_step")));
+                                                                  output_plots_step_));
                 if(static_cast<long>(plot_idx) - static_cast<long>(diff) < 0) {
                     min_idx_diff = std::min(min_idx_diff, diff - plot_idx);
                     continue;
@@ -376,12 +384,12 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
                 auto marker = std::make_unique<TPolyMarker3D>();
                 marker->SetMarkerStyle(kFullCircle);
                 marker->SetMarkerSize(static_cast<float>(deposit_points.first.getCharge() *
-                                                         config_.get<unsigned int>("output_animations_marker_size", 1)) /
+                                                         output_animations_marker_size_) /
                                       static_cast<float>(max_charge));
                 auto initial_z_perc = static_cast<int>(
                     ((points[0].z() + model_->getSensorSize().z() / 2.0) / model_->getSensorSize().z()) * 80);
                 initial_z_perc = std::max(std::min(79, initial_z_perc), 0);
-                if(config_.get<bool>("output_animations_color_markers")) {
+                if(output_animations_color_markers_) {
                     marker->SetMarkerColor(static_cast<Color_t>(colors[initial_z_perc]->GetNumber()));
                 }
                 marker->SetNextPoint(points[idx].x(), points[idx].y(), points[idx].z());
@@ -415,29 +423,25 @@ void GenericPropagationModule::create_output_plots(unsigned int event_num) {
                     switch(i) {
                     case 0 /* x */:
                         histogram_contour[i]->GetXaxis()->SetTitle(
-                            (std::string("y ") + (config_.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)"))
-                                .c_str());
+                            (std::string("y ") + (output_plots_use_pixel_units_ ? "(pixels)" : "(mm)")).c_str());
                         histogram_contour[i]->GetYaxis()->SetTitle("z (mm)");
                         break;
                     case 1 /* y */:
                         histogram_contour[i]->GetXaxis()->SetTitle(
-                            (std::string("x ") + (config_.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)"))
-                                .c_str());
+                            (std::string("x ") + (output_plots_use_pixel_units_ ? "(pixels)" : "(mm)")).c_str());
                         histogram_contour[i]->GetYaxis()->SetTitle("z (mm)");
                         break;
                     case 2 /* z */:
                         histogram_contour[i]->GetXaxis()->SetTitle(
-                            (std::string("x ") + (config_.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)"))
-                                .c_str());
+                            (std::string("x ") + (output_plots_use_pixel_units_ ? "(pixels)" : "(mm)")).c_str());
                         histogram_contour[i]->GetYaxis()->SetTitle(
-                            (std::string("y ") + (config_.get<bool>("output_plots_use_pixel_units") ? "(pixels)" : "(mm)"))
-                                .c_str());
+                            (std::string("y ") + (output_plots_use_pixel_units_ ? "(pixels)" : "(mm)")).c_str());
                         break;
                     default:;
                     }
                     histogram_contour[i]->SetMinimum(1);
                     histogram_contour[i]->SetMaximum(total_charge /
-                                                     config_.get<double>("output_plots_contour_max_scaling", 10));
+                                                     output_plots_contour_max_scaling_);
                     histogram_contour[i]->Draw("CONTZ 0");
                     if(point_cnt < tot_point_cnt - 1) {
                         canvas->Print((file_name_contour[i] + "+" + std::to_string(animation_time)).c_str());
@@ -461,6 +465,33 @@ void GenericPropagationModule::init() {
 
     auto detector = getDetector();
 
+    // Check the bound parameters
+    if(!propagate_electrons_ && !propagate_holes_) {
+        throw InvalidValueError(
+            config_,
+            "propagate_electrons",
+            "No charge carriers selected for propagation, enable 'propagate_electrons' or 'propagate_holes'.");
+    }
+    if(charge_groups_per_task_ == 0) {
+        throw InvalidValueError(
+            config_, "charge_groups_per_task", "number of sets per task should be strictly more than zero");
+    }
+    boltzmann_kT_ = Units::get(8.6173e-5, "eV/K") * temperature_;
+
+    // Tabulate the carrier mobility for the configured temperature
+    auto mobility_accuracy = config_.get<double>("mobility_accuracy");
+    if(mobility_accuracy < 0) {
+        throw InvalidValueError(config_, "mobility_accuracy", "accuracy of the mobility should not be negative");
+    }
+    electron_mobility_ = MobilityTable(JacoboniCanaliMobility::electron(temperature_), mobility_accuracy);
+    hole_mobility_ = MobilityTable(JacoboniCanaliMobility::hole(temperature_), mobility_accuracy);
+    if(electron_mobility_.getDeviation() > mobility_accuracy || hole_mobility_.getDeviation() > mobility_accuracy) {
+        throw InvalidValueError(config_, "mobility_accuracy", "accuracy cannot be reached by the mobility table");
+    }
+    LOG(DEBUG) << "Tabulated electron mobility in " << electron_mobility_.getBins() << " bins with maximum deviation "
+               << electron_mobility_.getDeviation() << ", hole mobility in " << hole_mobility_.getBins()
+               << " bins with maximum deviation " << hole_mobility_.getDeviation();
+
     // Check for electric field and output warning for slow propagation if not defined
     if(!detector->hasElectricField()) {
         LOG(WARNING) << "This detector does not have an electric field.";
@@ -477,10 +508,10 @@ void GenericPropagationModule::init() {
         auto efield = detector->getElectricField(probe_point);
         auto direction = std::signbit(efield.z());
         // Compare with propagated carrier type:
-        if(direction && !config_.get<bool>("propagate_electrons")) {
+        if(direction && !propagate_electrons_) {
             LOG(WARNING) << "Electric field indicates electron collection at implants, but electrons are not propagated!";
         }
-        if(!direction && !config_.get<bool>("propagate_holes")) {
+        if(!direction && !propagate_holes_) {
             LOG(WARNING) << "Electric field indicates hole collection at implants, but holes are not propagated!";
         }
     }
@@ -489,20 +520,23 @@ void GenericPropagationModule::init() {
     }
 }
 
+/**
+ * The deposits are split into sets of at most charge_per_step charges. These sets are divided in chunks, which are
+ * propagated as separate tasks in the thread pool. Every task uses its own random generator, seeded in order from the
+ * generator of the module, such that the result does not depend on the number of threads or the order in which the tasks
+ * are executed. The propagated charges are collected in the original order of the sets after all tasks have finished.
+ */
 void GenericPropagationModule::run(unsigned int event_num) {
+    // Seed the random generator for this event
+    random_generator_.seed(getEventSeed(event_num));
 
-    // Create vector of propagated charges to output
-    std::vector<PropagatedCharge> propagated_charges;
-
-    // Loop over all deposits for propagation
-    LOG(TRACE) << "Propagating charges in sensor";
-    unsigned int propagated_charges_count = 0;
-    unsigned int step_count = 0;
-    long double total_time = 0;
+    // Split all deposits in sets of charges to propagate
+    LOG(TRACE) << "Splitting deposits in sets of charges";
+    std::vector<std::pair<const DepositedCharge*, unsigned int>> charge_groups;
     for(auto& deposit : deposits_message_->getData()) {
 
-        if((deposit.getType() == CarrierType::ELECTRON && !config_.get<bool>("propagate_electrons")) ||
-           (deposit.getType() == CarrierType::HOLE && !config_.get<bool>("propagate_holes"))) {
+        if((deposit.getType() == CarrierType::ELECTRON && !propagate_electrons_) ||
+           (deposit.getType() == CarrierType::HOLE && !propagate_holes_)) {
             LOG(DEBUG) << "Skipping charge carriers (" << deposit.getType() << ") on "
                        << display_vector(deposit.getLocalPosition(), {"mm", "um"});
             continue;
@@ -514,7 +548,7 @@ void GenericPropagationModule::run(unsigned int event_num) {
         LOG(DEBUG) << "Set of charge carriers (" << deposit.getType() << ") on "
                    << display_vector(deposit.getLocalPosition(), {"mm", "um"});
 
-        auto charge_per_step = config_.get<unsigned int>("charge_per_step");
+        auto charge_per_step = charge_per_step_;
         while(charges_remaining > 0) {
             // Define number of charges to be propagated and remove charges of this step from the total
             if(charge_per_step > charges_remaining) {
@@ -522,44 +556,98 @@ void GenericPropagationModule::run(unsigned int event_num) {
             }
             charges_remaining -= charge_per_step;
 
-            // Get position and propagate through sensor
-            auto position = deposit.getLocalPosition();
+            charge_groups.emplace_back(&deposit, charge_per_step);
 
             // Add point of deposition to the output plots if requested
             if(output_plots_) {
+                auto position = deposit.getLocalPosition();
                 auto global_position = detector_->getGlobalPosition(position);
                 output_plot_points_.emplace_back(
                     PropagatedCharge(position, global_position, deposit.getType(), charge_per_step, deposit.getEventTime()),
                     std::vector<ROOT::Math::XYZPoint>());
             }
+        }
+    }
 
-            // Propagate a single charge deposit
-            auto prop_pair = propagate(position, deposit.getType());
-            position = prop_pair.first;
-
-            LOG(DEBUG) << " Propagated " << charge_per_step << " to " << display_vector(position, {"mm", "um"}) << " in "
-                       << Units::display(prop_pair.second, "ns") << " time";
+    // Submit the propagation of chunks of sets to the thread pool
+    LOG(TRACE) << "Propagating charges in sensor";
+    std::vector<std::pair<ROOT::Math::XYZPoint, double>> propagated_positions(charge_groups.size());
+    std::vector<std::future<void>> propagation_tasks;
+    for(size_t first = 0; first < charge_groups.size(); first += charge_groups_per_task_) {
+        auto last = std::min(first + charge_groups_per_task_, charge_groups.size());
+        auto propagate_chunk = [this, &charge_groups, &propagated_positions, first, last](uint64_t seed) {
+            std::mt19937_64 random_generator(seed);
+            if(batched_propagation_) {
+                // Propagate the sets in batches
+                for(size_t batch_first = first; batch_first < last; batch_first += static_cast<size_t>(batch_lanes_)) {
+                    auto batch_last = std::min(batch_first + static_cast<size_t>(batch_lanes_), last);
+                    std::vector<std::pair<ROOT::Math::XYZPoint, CarrierType>> carriers;
+                    std::vector<std::vector<ROOT::Math::XYZPoint>*> plot_points;
+                    for(size_t idx = batch_first; idx < batch_last; ++idx) {
+                        auto deposit = charge_groups[idx].first;
+                        carriers.emplace_back(deposit->getLocalPosition(), deposit->getType());
+                        if(output_plots_) {
+                            plot_points.push_back(&output_plot_points_[idx].second);
+                        }
+                    }
+                    auto batch_positions = propagate_batch(carriers, random_generator, plot_points);
+                    std::copy(batch_positions.begin(),
+                              batch_positions.end(),
+                              propagated_positions.begin() + static_cast<std::ptrdiff_t>(batch_first));
+                }
+            } else {
+                for(size_t idx = first; idx < last; ++idx) {
+                    auto* plot_points = (output_plots_ ? &output_plot_points_[idx].second : nullptr);
+                    auto deposit = charge_groups[idx].first;
+                    propagated_positions[idx] =
+                        propagate(deposit->getLocalPosition(), deposit->getType(), random_generator, plot_points);
+                }
+            }
+        };
+        propagation_tasks.push_back(getThreadPool().submit(this, propagate_chunk, random_generator_()));
+    }
 
-            // Create a new propagated charge and add it to the list
-            auto global_position = detector_->getGlobalPosition(position);
-            propagated_charges.emplace_back(position,
-                                            global_position,
-                                            deposit.getType(),
-                                            charge_per_step,
-                                            deposit.getEventTime() + prop_pair.second,
-                                            &deposit);
+    // Execute the tasks of this module and wait for all of them to finish
+    getThreadPool().execute(this);
+    for(auto& task : propagation_tasks) {
+        task.get();
+    }
 
-            // Update statistical information
-            ++step_count;
-            propagated_charges_count += charge_per_step;
-            total_time += charge_per_step * prop_pair.second;
+    // Create vector of propagated charges to output, reusing the memory of an earlier event
+    auto propagated_charges = BufferPool::acquire<PropagatedCharge>();
+    propagated_charges.reserve(charge_groups.size());
 
-            // Fill plot for drift time
-            if(output_plots_) {
-                drift_time_histo->SetBinContent(
-                    drift_time_histo->FindBin(prop_pair.second),
-                    drift_time_histo->GetBinContent(drift_time_histo->FindBin(prop_pair.second)) + charge_per_step);
-            }
+    // Merge the propagated sets in their original order
+    unsigned int propagated_charges_count = 0;
+    unsigned int step_count = 0;
+    long double total_time = 0;
+    for(size_t idx = 0; idx < charge_groups.size(); ++idx) {
+        auto deposit = charge_groups[idx].first;
+        auto charge = charge_groups[idx].second;
+        auto& prop_pair = propagated_positions[idx];
+
+        LOG(DEBUG) << " Propagated " << charge << " to " << display_vector(prop_pair.first, {"mm", "um"}) << " in "
+                   << Units::display(prop_pair.second, "ns") << " time";
+
+        // Create a new propagated charge and add it to the list
+        auto global_position = detector_->getGlobalPosition(prop_pair.first);
+        propagated_charges.emplace_back(prop_pair.first,
+                                        global_position,
+                                        deposit->getType(),
+                                        charge,
+                                        deposit->getEventTime() + prop_pair.second,
+                                        deposit);
+
+        // Update statistical information
+        ++step_count;
+        propagated_charges_count += charge;
+        total_time += charge * prop_pair.second;
+
+        // Fill plot for drift time
+        if(output_plots_) {
+            drift_time_histo->SetBinContent(
+                drift_time_histo->FindBin(prop_pair.second),
+                drift_time_histo->GetBinContent(drift_time_histo->FindBin(prop_pair.second)) + charge);
         }
     }
 
@@ -588,25 +676,17 @@ void GenericPropagationModule::run(unsigned int event_num) {
  * velocity at every point with help of the electric field map of the detector. An Runge-Kutta integration is applied in
  * multiple steps, adding a random diffusion to the propagating charge every step.
  */
-std::pair<ROOT::Math::XYZPoint, double> GenericPropagationModule::propagate(const ROOT::Math::XYZPoint& pos,
-                                                                            const CarrierType& type) {
+std::pair<ROOT::Math::XYZPoint, double>
+GenericPropagationModule::propagate(const ROOT::Math::XYZPoint& pos,
+                                    const CarrierType& type,
+                                    std::mt19937_64& random_generator,
+                                    std::vector<ROOT::Math::XYZPoint>* plot_points) const {
     // Create a runge kutta solver using the electric field as step function
     Eigen::Vector3d position(pos.x(), pos.y(), pos.z());
 
-    // Define a lambda function to compute the carrier mobility
-    // NOTE This function is typically the most frequently executed part of the framework and therefore the bottleneck
-    auto carrier_mobility = [&](double efield_mag) {
-        // Compute carrier mobility from constants and electric field magnitude
-        double numerator, denominator;
-        if(type == CarrierType::ELECTRON) {
-            numerator = electron_Vm_ / electron_Ec_;
-            denominator = std::pow(1. + std::pow(efield_mag / electron_Ec_, electron_Beta_), 1.0 / electron_Beta_);
-        } else {
-            numerator = hole_Vm_ / hole_Ec_;
-            denominator = std::pow(1. + std::pow(efield_mag / hole_Ec_, hole_Beta_), 1.0 / hole_Beta_);
-        }
-        return numerator / denominator;
-    };
+    // Select the table to compute the carrier mobility
+    // NOTE The mobility is typically the most frequently executed part of the framework and is therefore tabulated
+    auto& carrier_mobility = (type == CarrierType::ELECTRON ? electron_mobility_ : hole_mobility_);
 
     // Define a function to compute the diffusion
     auto carrier_diffusion = [&](double efield_mag, double timestep) -> Eigen::Vector3d {
@@ -617,7 +697,7 @@ std::pair<ROOT::Math::XYZPoint, double> GenericPropagationModule::propagate(cons
         std::normal_distribution<double> gauss_distribution(0, diffusion_std_dev);
         Eigen::Vector3d diffusion;
         for(int i = 0; i < 3; ++i) {
-            diffusion[i] = gauss_distribution(random_generator_);
+            diffusion[i] = gauss_distribution(random_generator);
         }
         return diffusion;
     };
@@ -641,11 +721,11 @@ std::pair<ROOT::Math::XYZPoint, double> GenericPropagationModule::propagate(cons
     while(detector_->isWithinSensor(static_cast<ROOT::Math::XYZPoint>(position)) &&
           runge_kutta.getTime() < integration_time_) {
         // Update output plots if necessary (depending on the plot step)
-        if(output_plots_) {
+        if(plot_points != nullptr) {
             auto time_idx = static_cast<size_t>(runge_kutta.getTime() / output_plots_step_);
             while(next_idx <= time_idx) {
-                output_plot_points_.back().second.push_back(static_cast<ROOT::Math::XYZPoint>(position));
-                next_idx = output_plot_points_.back().second.size();
+                plot_points->push_back(static_cast<ROOT::Math::XYZPoint>(position));
+                next_idx = plot_points->size();
             }
         }
 
@@ -691,26 +771,186 @@ std::pair<ROOT::Math::XYZPoint, double> GenericPropagationModule::propagate(cons
     }
 
     // Find proper final position in the sensor
-    auto time = runge_kutta.getTime();
-    if(!detector_->isWithinSensor(static_cast<ROOT::Math::XYZPoint>(position))) {
-        auto check_position = position;
-        check_position.z() = last_position.z();
-        if(position.z() > 0 && detector_->isWithinSensor(static_cast<ROOT::Math::XYZPoint>(check_position))) {
-            // Carrier left sensor on the side of the pixel grid, interpolate end point on surface
-            auto z_cur_border = std::fabs(position.z() - model_->getSensorSize().z() / 2.0);
-            auto z_last_border = std::fabs(model_->getSensorSize().z() / 2.0 - last_position.z());
-            auto z_total = z_cur_border + z_last_border;
-            position = (z_last_border / z_total) * position + (z_cur_border / z_total) * last_position;
-            time = (z_last_border / z_total) * time + (z_cur_border / z_total) * last_time;
-        } else {
-            // Carrier left sensor on any order border, use last position inside instead
-            position = last_position;
-            time = last_time;
+    return find_end_point(static_cast<ROOT::Math::XYZPoint>(position),
+                          runge_kutta.getTime(),
+                          static_cast<ROOT::Math::XYZPoint>(last_position),
+                          last_time);
+}
+
+/**
+ * The batched propagation follows the same algorithm as \ref GenericPropagationModule::propagate, but integrates multiple
+ * sets of charges at the same time using a \ref BatchedRungeKutta solver. The velocity, the diffusion width and the
+ * adaptation of the timestep are computed for all lanes together, which allows the compiler to vectorize these operations.
+ * Only the lookup of the electric field and mobility and the generation of the random diffusion are performed per set of
+ * charges. Sets which left the sensor or exceeded the integration time are masked and not updated anymore.
+ */
+std::vector<std::pair<ROOT::Math::XYZPoint, double>>
+GenericPropagationModule::propagate_batch(const std::vector<std::pair<ROOT::Math::XYZPoint, CarrierType>>& carriers,
+                                          std::mt19937_64& random_generator,
+                                          const std::vector<std::vector<ROOT::Math::XYZPoint>*>& plot_points) const {
+    using Values = Eigen::Array<double, batch_lanes_, 3>;
+    using Lanes = Eigen::Array<double, batch_lanes_, 1>;
+    using Mask = Eigen::Array<bool, batch_lanes_, 1>;
+    auto lanes = static_cast<int>(carriers.size());
+
+    // Initialize positions and the mobility of every lane (unused lanes are set to an inactive electron)
+    Values position;
+    Lanes sign;
+    Mask active;
+    std::vector<const MobilityTable*> mobility_tables;
+    position.setZero();
+    for(int lane = 0; lane < batch_lanes_; ++lane) {
+        auto type = (lane < lanes ? carriers[static_cast<size_t>(lane)].second : CarrierType::ELECTRON);
+        mobility_tables.push_back(type == CarrierType::ELECTRON ? &electron_mobility_ : &hole_mobility_);
+        sign(lane) = static_cast<int>(type);
+
+        active(lane) = false;
+        if(lane < lanes) {
+            auto& pos = carriers[static_cast<size_t>(lane)].first;
+            position.row(lane) << pos.x(), pos.y(), pos.z();
+            active(lane) = detector_->isWithinSensor(pos) && integration_time_ > 0;
+        }
+    }
+
+    // Define a lambda function to compute the carrier mobility of all lanes from the tables
+    auto carrier_mobility = [&](const Lanes& efield_mag) -> Lanes {
+        Lanes mobility;
+        for(int lane = 0; lane < batch_lanes_; ++lane) {
+            mobility(lane) = (*mobility_tables[static_cast<size_t>(lane)])(efield_mag(lane));
+        }
+        return mobility;
+    };
+
+    // Define a lambda function to look up the electric field of all active lanes
+    auto electric_field = [&](const Values& cur_pos, const Mask& cur_active) -> Values {
+        Values efield;
+        efield.setZero();
+        for(int lane = 0; lane < lanes; ++lane) {
+            if(cur_active(lane)) {
+                auto raw_field =
+                    detector_->getElectricField(ROOT::Math::XYZPoint(cur_pos(lane, 0), cur_pos(lane, 1), cur_pos(lane, 2)));
+                efield.row(lane) << raw_field.x(), raw_field.y(), raw_field.z();
+            }
+        }
+        return efield;
+    };
+
+    // Define a lambda function to compute the carrier velocity of all lanes
+    auto carrier_velocity = [&](const Lanes&, const Values& cur_pos, const Mask& cur_active) -> Values {
+        Values efield = electric_field(cur_pos, cur_active);
+        Lanes efield_mag = efield.square().rowwise().sum().sqrt();
+        Lanes mobility = sign * carrier_mobility(efield_mag);
+        return mobility.replicate<1, 3>() * efield;
+    };
+
+    // Create the batched runge kutta solver with an RKF5 tableau
+    auto runge_kutta = make_batched_runge_kutta<batch_lanes_>(tableau::RK5, carrier_velocity, timestep_start_, position);
+    runge_kutta.setActive(active);
+
+    // Continue propagation until all deposits are outside the sensor
+    Values last_position = position;
+    Lanes last_time = Lanes::Zero();
+    std::vector<size_t> next_idx(static_cast<size_t>(lanes), 0);
+    auto half_sensor_thickness = model_->getSensorSize().z() / 2.0;
+    while(active.any()) {
+        // Update output plots if necessary (depending on the plot step)
+        if(!plot_points.empty()) {
+            auto time = runge_kutta.getTime();
+            for(int lane = 0; lane < lanes; ++lane) {
+                auto& points = plot_points[static_cast<size_t>(lane)];
+                auto time_idx = static_cast<size_t>(time(lane) / output_plots_step_);
+                while(active(lane) && next_idx[static_cast<size_t>(lane)] <= time_idx) {
+                    points->emplace_back(position(lane, 0), position(lane, 1), position(lane, 2));
+                    next_idx[static_cast<size_t>(lane)] = points->size();
+                }
+            }
+        }
+
+        // Save previous position and time of the active lanes
+        last_position = active.replicate<1, 3>().select(position, last_position);
+        last_time = active.select(runge_kutta.getTime(), last_time);
+
+        // Execute a Runge Kutta step
+        auto step = runge_kutta.step();
+
+        // Get the current result and timestep
+        Lanes timestep = runge_kutta.getTimeStep();
+        position = runge_kutta.getValue();
+
+        // Apply diffusion step using the electric field at the current position
+        Values efield = electric_field(position, active);
+        Lanes diffusion_std_dev =
+            (2. * boltzmann_kT_ * carrier_mobility(efield.square().rowwise().sum().sqrt()) * timestep).sqrt();
+        for(int lane = 0; lane < lanes; ++lane) {
+            if(active(lane)) {
+                std::normal_distribution<double> gauss_distribution(0, diffusion_std_dev(lane));
+                for(int i = 0; i < 3; ++i) {
+                    position(lane, i) += gauss_distribution(random_generator);
+                }
+            }
+        }
+        runge_kutta.setValue(position);
+
+        // Adapt step size to match target precision, lowering the timestep when reaching the sensor edge
+        Lanes uncertainty = step.error.square().rowwise().sum().sqrt();
+        auto near_edge = (half_sensor_thickness - position.col(2)).abs() < 2 * step.value.col(2);
+        timestep = near_edge.select(
+            0.75 * timestep,
+            (uncertainty > target_spatial_precision_)
+                .select(0.75 * timestep, (2 * uncertainty < target_spatial_precision_).select(1.5 * timestep, timestep)));
+
+        // Limit the timestep to certain minimum and maximum step sizes
+        timestep = timestep.min(timestep_max_).max(timestep_min_);
+        runge_kutta.setTimeStep(timestep);
+
+        // Deactivate the lanes which left the sensor or exceeded the integration time
+        auto time = runge_kutta.getTime();
+        for(int lane = 0; lane < lanes; ++lane) {
+            if(active(lane)) {
+                active(lane) =
+                    detector_->isWithinSensor(ROOT::Math::XYZPoint(position(lane, 0), position(lane, 1), position(lane, 2)))
+                    && time(lane) < integration_time_;
+            }
         }
+        runge_kutta.setActive(active);
+    }
+
+    // Find proper final positions in the sensor
+    std::vector<std::pair<ROOT::Math::XYZPoint, double>> end_points;
+    auto time = runge_kutta.getTime();
+    for(int lane = 0; lane < lanes; ++lane) {
+        end_points.push_back(
+            find_end_point(ROOT::Math::XYZPoint(position(lane, 0), position(lane, 1), position(lane, 2)),
+                           time(lane),
+                           ROOT::Math::XYZPoint(last_position(lane, 0), last_position(lane, 1), last_position(lane, 2)),
+                           last_time(lane)));
+    }
+    return end_points;
+}
+
+std::pair<ROOT::Math::XYZPoint, double> GenericPropagationModule::find_end_point(const ROOT::Math::XYZPoint& position,
+                                                                                 double time,
+                                                                                 const ROOT::Math::XYZPoint& last_position,
+                                                                                 double last_time) const {
+    // Keep the position if the carrier did not leave the sensor
+    if(detector_->isWithinSensor(position)) {
+        return std::make_pair(position, time);
+    }
+
+    auto check_position = position;
+    check_position.SetZ(last_position.z());
+    if(position.z() > 0 && detector_->isWithinSensor(check_position)) {
+        // Carrier left sensor on the side of the pixel grid, interpolate end point on surface
+        auto z_cur_border = std::fabs(position.z() - model_->getSensorSize().z() / 2.0);
+        auto z_last_border = std::fabs(model_->getSensorSize().z() / 2.0 - last_position.z());
+        auto z_total = z_cur_border + z_last_border;
+        return std::make_pair(ROOT::Math::XYZPoint((z_last_border / z_total) * ROOT::Math::XYZVector(position) +
+                                                   (z_cur_border / z_total) * ROOT::Math::XYZVector(last_position)),
+                              (z_last_border / z_total) * time + (z_cur_border / z_total) * last_time);
     }
 
-    // Return the final position of the propagated charge
-    return std::make_pair(static_cast<ROOT::Math::XYZPoint>(position), time);
+    // Carrier left sensor on any order border, use last position inside instead
+    return std::make_pair(last_position, last_time);
 }
 
 void GenericPropagationModule::finalize() {
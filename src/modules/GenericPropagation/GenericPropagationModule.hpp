@@ -24,6 +24,8 @@
 #include "objects/DepositedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
 
+#include "tools/mobility.h"
+
 namespace allpix {
     /**
      * @ingroup Modules
@@ -34,6 +36,8 @@ namespace allpix {
      * combination of drift from a charge mobility parameterization and diffusion using a Gaussian random walk process.
      * Propagation continues until the charge deposits 'leave' the sensitive device. Sets of charges do not interact with
      * each other and are threated fully separate, allowing for a speed-up by propagating the charges in multiple threads.
+     * The sets are therefore split into chunks, which are submitted as separate tasks to the thread pool and merged
+     * afterwards in the original order of the deposits.
      */
     class GenericPropagationModule : public Module {
     public:
@@ -76,25 +80,66 @@ namespace allpix {
          * @brief Propagate a single set of charges through the sensor
          * @param pos Position of the deposit in the sensor
          * @param type Type of the carrier to propagate
+         * @param random_generator Random generator used for the diffusion of this set of charges
+         * @param plot_points Optional list to store the points of the path for the output plots
+         * @return Pair of the point where the deposit ended after propagation and the time the propagation took
+         * @note This method can be called from multiple threads at the same time
+         */
+        std::pair<ROOT::Math::XYZPoint, double> propagate(const ROOT::Math::XYZPoint& pos,
+                                                          const CarrierType& type,
+                                                          std::mt19937_64& random_generator,
+                                                          std::vector<ROOT::Math::XYZPoint>* plot_points) const;
+
+        /**
+         * @brief Propagate a batch of sets of charges through the sensor at the same time
+         * @param carriers Positions of the deposits in the sensor and the types of the carriers to propagate
+         * @param random_generator Random generator used for the diffusion of the sets of charges
+         * @param plot_points Optional lists to store the points of the paths for the output plots (empty if not required)
+         * @return List of pairs of the points where the deposits ended after propagation and the time the propagation took
+         * @note At most \ref batch_lanes_ sets of charges can be propagated in a single batch
+         */
+        std::vector<std::pair<ROOT::Math::XYZPoint, double>>
+        propagate_batch(const std::vector<std::pair<ROOT::Math::XYZPoint, CarrierType>>& carriers,
+                        std::mt19937_64& random_generator,
+                        const std::vector<std::vector<ROOT::Math::XYZPoint>*>& plot_points) const;
+
+        /**
+         * @brief Find the final position of a propagated set of charges inside the sensor
+         * @param position Position of the set of charges after the last step
+         * @param time Time of the set of charges after the last step
+         * @param last_position Position of the set of charges before the last step
+         * @param last_time Time of the set of charges before the last step
          * @return Pair of the point where the deposit ended after propagation and the time the propagation took
          */
-        std::pair<ROOT::Math::XYZPoint, double> propagate(const ROOT::Math::XYZPoint& pos, const CarrierType& type);
+        std::pair<ROOT::Math::XYZPoint, double> find_end_point(const ROOT::Math::XYZPoint& position,
+                                                               double time,
+                                                               const ROOT::Math::XYZPoint& last_position,
+                                                               double last_time) const;
 
-        // Random generator for this module
+        // Number of sets of charges propagated together in batched propagation
+        static constexpr int batch_lanes_ = 8;
+
+        // Random generator for this module, used to seed the random generators of the propagation tasks
         std::mt19937_64 random_generator_;
 
         // Local copies of configuration parameters to avoid costly lookup:
         double temperature_{}, timestep_min_{}, timestep_max_{}, timestep_start_{}, integration_time_{},
             target_spatial_precision_{}, output_plots_step_{};
+        unsigned int charge_groups_per_task_{}, charge_per_step_{};
+        bool propagate_electrons_{}, propagate_holes_{};
+        bool batched_propagation_{};
         bool output_plots_{};
 
-        // Precalculated values for electron and hole mobility
-        double electron_Vm_;
-        double electron_Ec_;
-        double electron_Beta_;
-        double hole_Vm_;
-        double hole_Ec_;
-        double hole_Beta_;
+        // Local copies of the configuration parameters of the output plots
+        double output_plots_theta_{}, output_plots_phi_{}, output_plots_contour_max_scaling_{};
+        long double output_animations_time_scaling_{};
+        unsigned int output_animations_marker_size_{};
+        bool output_plots_use_pixel_units_{}, output_plots_use_equal_scaling_{}, output_plots_align_pixels_{};
+        bool output_animations_{}, output_animations_color_markers_{};
+
+        // Tabulated electron and hole mobility
+        MobilityTable electron_mobility_;
+        MobilityTable hole_mobility_;
 
         // Precalculated value for Boltzmann constant:
         double boltzmann_kT_;
@@ -36,6 +36,11 @@
 #include "G4GDMLParser.hh"
 #endif
 
+// Include the multithreaded run manager if Geant4 is built with multithreading support
+#ifdef G4MULTITHREADED
+#include <G4MTRunManager.hh>
+#endif
+
 using namespace allpix;
 using namespace ROOT;
 
@@ -74,12 +79,31 @@ void GeometryBuilderGeant4Module::init() {
     check_dataset_g4("G4ENSDFSTATEDATA");
     check_dataset_g4("G4LEDATA");
 
+    // Check if multithreading is requested and available
+    auto geant4_threads = config_.get<unsigned int>("geant4_threads", 0);
+#ifndef G4MULTITHREADED
+    if(geant4_threads != 0) {
+        throw InvalidValueError(
+            config_, "geant4_threads", "Geant4 is built without multithreading support, use zero threads instead");
+    }
+#endif
+
     // Suppress all output (also stdout due to a part in Geant4 where G4cout is not used)
     SUPPRESS_STREAM(std::cout);
     SUPPRESS_STREAM(G4cout);
 
-    // Create the G4 run manager
+    // Create the G4 run manager, using worker threads for the tracking if requested
+#ifdef G4MULTITHREADED
+    if(geant4_threads != 0) {
+        auto mt_run_manager = std::make_unique<G4MTRunManager>();
+        mt_run_manager->SetNumberOfThreads(static_cast<int>(geant4_threads));
+        run_manager_g4_ = std::move(mt_run_manager);
+    } else {
+        run_manager_g4_ = std::make_unique<G4RunManager>();
+    }
+#else
     run_manager_g4_ = std::make_unique<G4RunManager>();
+#endif
 
     // Release stdout again
     RELEASE_STREAM(std::cout);
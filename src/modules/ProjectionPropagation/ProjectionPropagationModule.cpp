@@ -15,6 +15,7 @@
 #include "core/utils/log.h"
 #include "objects/DepositedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
+#include "tools/mobility.h"
 
 using namespace allpix;
 
@@ -25,16 +26,16 @@ ProjectionPropagationModule::ProjectionPropagationModule(Configuration config,
     // Save detector model
     model_ = detector_->getModel();
 
-    random_generator_.seed(getRandomSeed());
-
     // Require deposits message for single detector
     messenger_->bindSingle(this, &ProjectionPropagationModule::deposits_message_, MsgFlags::REQUIRED);
 
     // Set default value for config variables
     config_.setDefault<int>("charge_per_step", 10);
     config_.setDefault<bool>("output_plots", false);
+    config_.setDefault<double>("mobility_accuracy", 1e-4);
 
-    output_plots_ = config_.get<bool>("output_plots");
+    bind_parameter(config_, "output_plots", output_plots_);
+    bind_parameter(config_, "charge_per_step", charge_per_step_);
 
     // Set default for charge carrier propagation:
     config_.setDefault<bool>("propagate_holes", false);
@@ -45,16 +46,7 @@ ProjectionPropagationModule::ProjectionPropagationModule(Configuration config,
         propagate_type_ = CarrierType::ELECTRON;
     }
 
-    // Parameterization variables from https://doi.org/10.1016/0038-1101(77)90054-5 (section 5.2)
     auto temperature = config_.get<double>("temperature");
-    electron_Vm_ = Units::get(1.53e9 * std::pow(temperature, -0.87), "cm/s");
-    electron_Ec_ = Units::get(1.01 * std::pow(temperature, 1.55), "V/cm");
-    electron_Beta_ = 2.57e-2 * std::pow(temperature, 0.66);
-
-    hole_Vm_ = Units::get(1.62e8 * std::pow(temperature, -0.52), "cm/s");
-    hole_Ec_ = Units::get(1.24 * std::pow(temperature, 1.68), "V/cm");
-    hole_Beta_ = 0.46 * std::pow(temperature, 0.17);
-
     boltzmann_kT_ = Units::get(8.6173e-5, "eV/K") * temperature;
 }
 
@@ -63,16 +55,33 @@ void ProjectionPropagationModule::init() {
         throw ModuleError("This module should only be used with linear electric fields.");
     }
 
+    // Tabulate the mobility of the propagated carrier type for the configured temperature
+    auto temperature = config_.get<double>("temperature");
+    auto mobility_accuracy = config_.get<double>("mobility_accuracy");
+    if(mobility_accuracy < 0) {
+        throw InvalidValueError(config_, "mobility_accuracy", "accuracy of the mobility should not be negative");
+    }
+    mobility_ = MobilityTable(propagate_type_ == CarrierType::ELECTRON ? JacoboniCanaliMobility::electron(temperature)
+                                                                       : JacoboniCanaliMobility::hole(temperature),
+                              mobility_accuracy);
+    if(mobility_.getDeviation() > mobility_accuracy) {
+        throw InvalidValueError(config_, "mobility_accuracy", "accuracy cannot be reached by the mobility table");
+    }
+    LOG(DEBUG) << "Tabulated mobility in " << mobility_.getBins() << " bins with maximum deviation "
+               << mobility_.getDeviation();
+
     if(output_plots_) {
         // Initialize output plot
         drift_time_histo = new TH1D("drift_time_histo", "Drift time;t[ns];particles", 75, 0., 25.);
     }
 }
 
-void ProjectionPropagationModule::run(unsigned int) {
+void ProjectionPropagationModule::run(unsigned int event_num) {
+    // Seed the random generator for this event
+    random_generator_.seed(getEventSeed(event_num));
 
-    // Create vector of propagated charges to output
-    std::vector<PropagatedCharge> propagated_charges;
+    // Create vector of propagated charges to output, reusing the memory of an earlier event
+    auto propagated_charges = BufferPool::acquire<PropagatedCharge>();
     auto model = detector_->getModel();
 
     double charge_lost = 0;
@@ -93,19 +102,8 @@ void ProjectionPropagationModule::run(unsigned int) {
         LOG(DEBUG) << "Set of " << deposit.getCharge() << " charge carriers (" << type << ") on "
                    << display_vector(position, {"mm", "um"});
 
-        // Define a lambda function to compute the carrier mobility
-        auto carrier_mobility = [&](double efield_mag) {
-            // Compute carrier mobility from constants and electric field magnitude
-            double numerator, denominator;
-            if(type == CarrierType::ELECTRON) {
-                numerator = electron_Vm_ / electron_Ec_;
-                denominator = std::pow(1. + std::pow(efield_mag / electron_Ec_, electron_Beta_), 1.0 / electron_Beta_);
-            } else {
-                numerator = hole_Vm_ / hole_Ec_;
-                denominator = std::pow(1. + std::pow(efield_mag / hole_Ec_, hole_Beta_), 1.0 / hole_Beta_);
-            }
-            return numerator / denominator;
-        };
+        // Use the tabulated mobility of the propagated carrier type
+        auto& carrier_mobility = mobility_;
 
         // Get the electric field at the position of the deposited charge and the top of the sensor:
         auto efield = detector_->getElectricField(position);
@@ -120,8 +118,8 @@ void ProjectionPropagationModule::run(unsigned int) {
 
         // Calculate the drift time
         auto calc_drift_time = [&]() {
-            double Ec = (type == CarrierType::ELECTRON ? electron_Ec_ : hole_Ec_);
-            double zero_mobility = (type == CarrierType::ELECTRON ? electron_Vm_ / electron_Ec_ : hole_Vm_ / hole_Ec_);
+            double Ec = mobility_.getModel().getCriticalField();
+            double zero_mobility = mobility_.getModel().getZeroFieldMobility();
 
             return ((log(efield_mag_top) - log(efield_mag)) / slope_efield_ +
                     (model->getSensorSize().z() / 2. - position.z()) / Ec) /
@@ -156,7 +154,7 @@ void ProjectionPropagationModule::run(unsigned int) {
         unsigned int charges_remaining = deposit.getCharge();
         total_charge += charges_remaining;
 
-        auto charge_per_step = config_.get<unsigned int>("charge_per_step");
+        auto charge_per_step = charge_per_step_;
         while(charges_remaining > 0) {
             if(charge_per_step > charges_remaining) {
                 charge_per_step = charges_remaining;
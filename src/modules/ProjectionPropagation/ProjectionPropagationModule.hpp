@@ -21,6 +21,8 @@
 #include "objects/DepositedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
 
+#include "tools/mobility.h"
+
 namespace allpix {
     /**
      * @ingroup Modules
@@ -66,17 +68,13 @@ namespace allpix {
 
         // Config parameters: Check whether plots should be generated
         bool output_plots_;
+        unsigned int charge_per_step_{};
 
         // Carrier type to be propagated
         CarrierType propagate_type_;
 
-        // Precalculated values for electron and hole mobility
-        double hole_Vm_;
-        double hole_Ec_;
-        double hole_Beta_;
-        double electron_Vm_;
-        double electron_Ec_;
-        double electron_Beta_;
+        // Tabulated mobility of the propagated carrier type
+        MobilityTable mobility_;
 
         // Calculated slope of the electric field
         double slope_efield_;
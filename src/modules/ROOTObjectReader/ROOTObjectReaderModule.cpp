@@ -9,14 +9,19 @@
 
 #include "ROOTObjectReaderModule.hpp"
 
+#include <chrono>
 #include <climits>
+#include <fstream>
 #include <string>
 #include <utility>
 
 #include <TBranch.h>
 #include <TKey.h>
 #include <TObjArray.h>
+#include <TROOT.h>
 #include <TTree.h>
+#include <TTreeCache.h>
+#include <TTreeCacheUnzip.h>
 
 #include "core/messenger/Messenger.hpp"
 #include "core/utils/log.h"
@@ -30,7 +35,12 @@
 using namespace allpix;
 
 ROOTObjectReaderModule::ROOTObjectReaderModule(Configuration config, Messenger* messenger, GeometryManager* geo_mgr)
-    : Module(config), config_(std::move(config)), messenger_(messenger), geo_mgr_(geo_mgr) {}
+    : Module(config), config_(std::move(config)), messenger_(messenger), geo_mgr_(geo_mgr) {
+    // Set defaults for the caching of the input trees
+    config_.setDefault<Long64_t>("cache_size", 30000000);
+    config_.setDefault<bool>("prefetching", false);
+    config_.setDefault<bool>("parallel_unzip", false);
+}
 
 /**
  * @note Objects cannot be stored in smart pointers due to internal ROOT logic
@@ -93,6 +103,19 @@ void ROOTObjectReaderModule::init() {
     // Initialize the call map from the tuple of available objects
     message_creator_map_ = gen_creator_map<allpix::OBJECTS>();
 
+    // Decompress the baskets in the read cache in parallel if requested, this should be set before creating the caches
+    if(config_.get<bool>("parallel_unzip")) {
+        // The thread safety of ROOT is enabled by the framework if multithreading is enabled
+        auto workers = config_.get<unsigned int>("_workers", 0u);
+        if(workers == 0) {
+            throw InvalidValueError(
+                config_, "parallel_unzip", "parallel decompression requires experimental_multithreading to be enabled");
+        }
+        LOG(DEBUG) << "Enabling parallel decompression of the input baskets with " << workers << " threads";
+        ROOT::EnableImplicitMT(workers);
+        TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+    }
+
     // Open the file with the objects
     input_file_ = std::make_unique<TFile>(config_.getPath("file_name", true).c_str());
 
@@ -129,6 +152,65 @@ void ROOTObjectReaderModule::init() {
         LOG(ERROR) << "Provided ROOT file does not contain any trees, module is useless!";
     }
 
+    // Select the entries to read for the events
+    int selections = static_cast<int>(config_.has("skip_events")) + static_cast<int>(config_.has("event_range")) +
+                     static_cast<int>(config_.has("entry_list"));
+    if(selections > 1) {
+        throw InvalidValueError(
+            config_, "skip_events", "skip_events, event_range and entry_list parameters are mutually exclusive");
+    }
+    if(config_.has("skip_events")) {
+        first_entry_ = config_.get<Long64_t>("skip_events");
+        if(first_entry_ < 0) {
+            throw InvalidValueError(config_, "skip_events", "number of events to skip cannot be negative");
+        }
+    } else if(config_.has("event_range")) {
+        auto range = config_.getArray<Long64_t>("event_range");
+        if(range.size() != 2 || range[0] < 0 || range[1] < range[0]) {
+            throw InvalidValueError(config_, "event_range", "range should consist of the first and the last entry to read");
+        }
+        first_entry_ = range[0];
+        last_entry_ = range[1];
+    } else if(config_.has("entry_list")) {
+        std::ifstream file(config_.getPath("entry_list", true));
+        Long64_t entry;
+        while(file >> entry) {
+            if(entry < 0) {
+                throw InvalidValueError(config_, "entry_list", "list contains a negative entry");
+            }
+            entries_.push_back(entry);
+        }
+        if(!file.eof() || entries_.empty()) {
+            throw InvalidValueError(config_, "entry_list", "list should contain one or more entry numbers");
+        }
+        LOG(DEBUG) << "Reading " << entries_.size() << " entries from the entry list";
+    }
+
+    // Enable the read cache of the trees for all branches, as every branch is read for every entry
+    auto cache_size = config_.get<Long64_t>("cache_size");
+    if(cache_size < 0) {
+        throw InvalidValueError(config_, "cache_size", "cache size cannot be negative");
+    }
+    if(cache_size > 0) {
+        for(auto& tree : trees_) {
+            tree->SetCacheSize(cache_size);
+            tree->AddBranchToCache("*", true);
+
+            // Only cache the selected range, such that the entries outside of it are never read. An entry list is not
+            // limited to a range, the cache reads the clusters of the listed entries when they are requested.
+            if(entries_.empty()) {
+                tree->SetCacheEntryRange(first_entry_, (last_entry_ < 0 ? tree->GetEntries() : last_entry_ + 1));
+            }
+
+            // Read the baskets of the next entries in a background thread while the current entry is processed
+            auto cache = tree->GetReadCache(input_file_.get());
+            if(cache != nullptr && config_.get<bool>("prefetching")) {
+                cache->SetEnablePrefetching(true);
+            }
+        }
+        LOG(DEBUG) << "Enabled read cache of " << cache_size << " bytes for every tree";
+    }
+
     // Loop over all found trees
     for(auto& tree : trees_) {
         // Loop over the list of branches and create the set of receiver objects
@@ -188,15 +270,34 @@ void ROOTObjectReaderModule::init() {
     }
 }
 
+/**
+ * Events are mapped to the entries of the trees in order, starting at the first selected entry. Reading an entry does not
+ * require reading any of the entries before it.
+ */
 void ROOTObjectReaderModule::run(unsigned int event_num) {
-    --event_num;
+    // Find the entry of this event
+    Long64_t entry = -1;
+    if(!entries_.empty()) {
+        if(event_num <= entries_.size()) {
+            entry = entries_[event_num - 1];
+        }
+    } else if(last_entry_ < 0 || first_entry_ + event_num - 1 <= last_entry_) {
+        entry = first_entry_ + event_num - 1;
+    }
+    if(entry < 0) {
+        LOG(WARNING) << "Skipping run because no entry is selected for event " << event_num;
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
     for(auto& tree : trees_) {
-        if(event_num >= tree->GetEntries()) {
-            LOG(WARNING) << "Skipping run because tree does not contain data for event " << event_num;
+        if(entry >= tree->GetEntries()) {
+            LOG(WARNING) << "Skipping run because tree does not contain data for entry " << entry;
             return;
         }
-        tree->GetEntry(event_num);
+        tree->GetEntry(entry);
     }
+    read_time_ += std::chrono::steady_clock::now() - start;
     LOG(TRACE) << "Building messages from stored objects";
 
     // Loop through all branches
@@ -236,6 +337,8 @@ void ROOTObjectReaderModule::finalize() {
 
     // Print statistics
     LOG(INFO) << "Read " << read_cnt_ << " objects from " << branch_count << " branches";
+    LOG(INFO) << "Read " << input_file_->GetBytesRead() << " bytes in " << input_file_->GetReadCalls()
+              << " read calls, spending " << std::chrono::duration<double>(read_time_).count() << "s reading entries";
 
     // Close the file
     input_file_->Close();
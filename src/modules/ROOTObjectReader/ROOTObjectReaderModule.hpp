@@ -7,6 +7,7 @@
  * Intergovernmental Organization or submit itself to any jurisdiction.
  */
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <string>
@@ -87,11 +88,17 @@ namespace allpix {
         // Object trees in the file
         std::vector<TTree*> trees_;
 
+        // Selection of the entries to read, either a range of entries or an explicit list of entries
+        Long64_t first_entry_{0};
+        Long64_t last_entry_{-1};
+        std::vector<Long64_t> entries_;
+
         // List of objects and message information converted from the trees
         std::list<message_info> message_info_array_;
 
-        // Statistics for total amount of objects stored
+        // Statistics for total amount of objects stored and the time spent reading the entries
         unsigned long read_cnt_{};
+        std::chrono::steady_clock::duration read_time_{};
 
         // Internal map to construct an object from it's type index
         MessageCreatorMap message_creator_map_;
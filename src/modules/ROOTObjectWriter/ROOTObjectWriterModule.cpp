@@ -9,6 +9,9 @@
 
 #include "ROOTObjectWriterModule.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <fstream>
 #include <string>
 #include <utility>
@@ -29,11 +32,21 @@ ROOTObjectWriterModule::ROOTObjectWriterModule(Configuration config, Messenger*
     : Module(config), config_(std::move(config)), geo_mgr_(geo_mgr) {
     // Bind to all messages
     messenger->registerListener(this, &ROOTObjectWriterModule::receive);
+
+    // Set defaults for the compression and the buffering of the output trees
+    config_.setDefault<std::string>("compression_algorithm", "zlib");
+    config_.setDefault<int>("compression_level", 1);
+    config_.setDefault<int>("basket_size", 32000);
+    config_.setDefault<Long64_t>("auto_flush", -30000000);
+    config_.setDefault<Long64_t>("auto_save", -300000000);
 }
 /**
  * @note Objects cannot be stored in smart pointers due to internal ROOT logic
  */
 ROOTObjectWriterModule::~ROOTObjectWriterModule() {
+    // Stop the writer thread if the module did not finalize
+    stop_writer();
+
     // Delete all object pointers
     for(auto& index_data : write_list_) {
         delete index_data.second;
@@ -46,6 +59,37 @@ void ROOTObjectWriterModule::init() {
     output_file_ = std::make_unique<TFile>(file_name.c_str(), "RECREATE");
     output_file_->cd();
 
+    // Set the compression of the file, encoded by ROOT as hundred times the algorithm plus the level
+    auto algorithm = config_.get<std::string>("compression_algorithm");
+    std::transform(algorithm.begin(), algorithm.end(), algorithm.begin(), ::tolower);
+    int algorithm_code;
+    if(algorithm == "zlib") {
+        algorithm_code = 1;
+    } else if(algorithm == "lzma") {
+        algorithm_code = 2;
+    } else if(algorithm == "lz4") {
+        algorithm_code = 4;
+    } else if(algorithm == "zstd") {
+        algorithm_code = 5;
+    } else {
+        throw InvalidValueError(
+            config_, "compression_algorithm", "compression algorithm should be 'zlib', 'lzma', 'lz4' or 'zstd'");
+    }
+    auto level = config_.get<int>("compression_level");
+    if(level < 0 || level > 9) {
+        throw InvalidValueError(config_, "compression_level", "compression level should be between 0 and 9");
+    }
+    output_file_->SetCompressionSettings(algorithm_code * 100 + level);
+    LOG(DEBUG) << "Compressing output with " << algorithm << " at level " << level;
+
+    // Read the buffering of the trees
+    basket_size_ = config_.get<int>("basket_size");
+    if(basket_size_ <= 0) {
+        throw InvalidValueError(config_, "basket_size", "basket size should be strictly more than zero");
+    }
+    auto_flush_ = config_.get<Long64_t>("auto_flush");
+    auto_save_ = config_.get<Long64_t>("auto_save");
+
     // Read include and exclude list
     if(config_.has("include") && config_.has("exclude")) {
         throw InvalidValueError(config_, "exclude", "include and exclude parameter are mutually exclusive");
@@ -56,6 +100,23 @@ void ROOTObjectWriterModule::init() {
         auto exc_arr = config_.getArray<std::string>("exclude");
         exclude_.insert(exc_arr.begin(), exc_arr.end());
     }
+
+    // Start the thread writing the events in the background if requested
+    async_writing_ = config_.get<bool>("async_writing", false);
+    async_queue_size_ = config_.get<size_t>("async_queue_size", 8);
+    if(async_writing_) {
+        // Trees are filled from the writer thread while other modules use ROOT in the event loop, which requires the
+        // thread safety of ROOT that is enabled by the framework if multithreading is enabled
+        if(config_.get<unsigned int>("_workers", 0u) == 0) {
+            throw InvalidValueError(
+                config_, "async_writing", "asynchronous writing requires experimental_multithreading to be enabled");
+        }
+        if(async_queue_size_ == 0) {
+            throw InvalidValueError(config_, "async_queue_size", "size of the queue should be strictly more than zero");
+        }
+        LOG(TRACE) << "Starting background writer thread with a queue of " << async_queue_size_ << " events";
+        writer_thread_ = std::thread(&ROOTObjectWriterModule::writer_loop, this);
+    }
 }
 
 void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::string message_name) { // NOLINT
@@ -76,8 +137,6 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
         // Read the object
         auto object_array = message->getObjectArray();
         if(!object_array.empty()) {
-            keep_messages_.push_back(message);
-
             const Object& first_object = object_array[0];
             std::type_index type_idx = typeid(first_object);
 
@@ -103,6 +162,9 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
                     return;
                 }
 
+                // The trees cannot be changed while the writer thread is filling them
+                std::lock_guard<std::mutex> lock{write_mutex_};
+
                 // Add vector of objects to write to the write list
                 write_list_[index_tuple] = new std::vector<Object*>();
                 auto addr = &write_list_[index_tuple];
@@ -116,6 +178,10 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
 
                     // Enable saving references
                     insert_result.first->second->BranchRef();
+
+                    // Set when the baskets are flushed and when the tree header is saved
+                    insert_result.first->second->SetAutoFlush(auto_flush_);
+                    insert_result.first->second->SetAutoSave(auto_save_);
                 }
 
                 std::string branch_name = detector_name;
@@ -124,15 +190,31 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
                     branch_name += message_name;
                 }
 
-                trees_[class_name]->Bronch(
-                    branch_name.c_str(), (std::string("std::vector<") + cls->GetName() + "*>").c_str(), addr);
+                trees_[class_name]->Bronch(branch_name.c_str(),
+                                           (std::string("std::vector<") + cls->GetName() + "*>").c_str(),
+                                           addr,
+                                           basket_size_);
             }
 
-            // Fill the branch vector
-            for(Object& object : object_array) {
-                ++write_cnt_;
-                write_list_[index_tuple]->push_back(&object);
+            // Fill the branch vector directly, unless the writer thread can be reading it
+            auto branch = write_list_[index_tuple];
+            if(!async_writing_) {
+                for(Object& object : object_array) {
+                    ++write_cnt_;
+                    branch->push_back(&object);
+                }
+            } else {
+                // Store the objects to fill the branch vector when the event is written
+                std::vector<Object*> objects;
+                objects.reserve(object_array.size());
+                for(Object& object : object_array) {
+                    ++write_cnt_;
+                    objects.push_back(&object);
+                }
+                current_event_.objects.emplace_back(branch, std::move(objects));
             }
+            // Keep the message, as it owns the objects in the branch vector
+            current_event_.messages.push_back(message);
         }
 
     } catch(MessageWithoutObjectException& e) {
@@ -142,11 +224,43 @@ void ROOTObjectWriterModule::receive(std::shared_ptr<BaseMessage> message, std::
     }
 }
 
+/**
+ * In the asynchronous mode the event is handed over to the writer thread, waiting for space in the queue if the writer
+ * thread cannot keep up with the simulation. Otherwise the event is written directly.
+ */
 void ROOTObjectWriterModule::run(unsigned int) {
+    EventData event;
+    std::swap(event, current_event_);
+
+    if(!async_writing_) {
+        write_event(std::move(event));
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock{queue_mutex_};
+    queue_condition_.wait(lock,
+                          [this]() { return queue_.size() < async_queue_size_ || writer_exception_ != nullptr; });
+    if(writer_exception_ != nullptr) {
+        std::rethrow_exception(writer_exception_);
+    }
+    queue_.push_back(std::move(event));
+    lock.unlock();
+    queue_condition_.notify_all();
+}
+
+void ROOTObjectWriterModule::write_event(EventData event) {
     LOG(TRACE) << "Writing new objects to tree";
+    std::lock_guard<std::mutex> lock{write_mutex_};
+    auto start = std::chrono::steady_clock::now();
     output_file_->cd();
 
-    // Fill the tree with the current received messages
+    // Fill the branch vectors with the objects of the event (only stored separately when writing asynchronously)
+    for(auto& branch_objects : event.objects) {
+        auto& branch = *branch_objects.first;
+        branch.insert(branch.end(), branch_objects.second.begin(), branch_objects.second.end());
+    }
+
+    // Fill the tree with the received messages
     for(auto& tree : trees_) {
         tree.second->Fill();
     }
@@ -155,20 +269,63 @@ void ROOTObjectWriterModule::run(unsigned int) {
     for(auto& index_data : write_list_) {
         index_data.second->clear();
     }
-    // Clear the messages we have to keep because they contain the internal pointers
-    keep_messages_.clear();
+
+    // Update statistics
+    ++write_events_;
+    write_time_ += std::chrono::steady_clock::now() - start;
+    // The messages that contain the internal pointers are released when the event goes out of scope
+}
+
+void ROOTObjectWriterModule::writer_loop() {
+    while(true) {
+        EventData event;
+        {
+            std::unique_lock<std::mutex> lock{queue_mutex_};
+            queue_condition_.wait(lock, [this]() { return !queue_.empty() || stop_writer_; });
+            if(queue_.empty()) {
+                return;
+            }
+            event = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        queue_condition_.notify_all();
+
+        try {
+            write_event(std::move(event));
+        } catch(...) {
+            // Pass the exception to the event loop and stop writing
+            std::lock_guard<std::mutex> lock{queue_mutex_};
+            writer_exception_ = std::current_exception();
+            queue_.clear();
+            queue_condition_.notify_all();
+            return;
+        }
+    }
+}
+
+void ROOTObjectWriterModule::stop_writer() {
+    if(!writer_thread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{queue_mutex_};
+        stop_writer_ = true;
+    }
+    queue_condition_.notify_all();
+    writer_thread_.join();
 }
 
 void ROOTObjectWriterModule::finalize() {
+    // Wait until the writer thread has written all events
+    stop_writer();
+    if(writer_exception_ != nullptr) {
+        std::rethrow_exception(writer_exception_);
+    }
+
     LOG(TRACE) << "Writing objects to file";
     output_file_->cd();
 
-    int branch_count = 0;
-    for(auto& tree : trees_) {
-        // Update statistics
-        branch_count += tree.second->GetListOfBranches()->GetEntries();
-    }
-
     // Save the main configuration to the output file if possible
     // FIXME This should be improved to write the information in a more flexible way
     std::string path = config_.getFilePath();
@@ -230,9 +387,29 @@ void ROOTObjectWriterModule::finalize() {
     }
 
     // Finish writing to output file
+    auto start = std::chrono::steady_clock::now();
     output_file_->Write();
+    write_time_ += std::chrono::steady_clock::now() - start;
+
+    // Update statistics (only after writing, the baskets still in memory are not compressed before)
+    int branch_count = 0;
+    Long64_t total_bytes = 0;
+    Long64_t zip_bytes = 0;
+    for(auto& tree : trees_) {
+        branch_count += tree.second->GetListOfBranches()->GetEntries();
+        total_bytes += tree.second->GetTotBytes();
+        zip_bytes += tree.second->GetZipBytes();
+    }
 
     // Print statistics
     LOG(STATUS) << "Wrote " << write_cnt_ << " objects to " << branch_count << " branches in file:" << std::endl
                 << getOutputPath(config_.get<std::string>("file_name", "data") + ".root", true);
+    if(write_events_ != 0) {
+        auto file_bytes = static_cast<double>(output_file_->GetBytesWritten());
+        auto write_time = std::chrono::duration<double>(write_time_).count();
+        LOG(INFO) << "Wrote " << write_events_ << " events with " << file_bytes / static_cast<double>(write_events_)
+                  << " bytes per event, " << static_cast<double>(total_bytes) / std::max(static_cast<double>(zip_bytes), 1.0)
+                  << " compression factor of the trees and " << (write_time > 0 ? file_bytes / write_time / 1e6 : 0.0)
+                  << " MB/s write throughput";
+    }
 }
@@ -7,8 +7,14 @@
  * Intergovernmental Organization or submit itself to any jurisdiction.
  */
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include <TFile.h>
 #include <TTree.h>
@@ -65,6 +71,31 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Objects received in a single event, together with the messages that own them
+         */
+        struct EventData {
+            std::vector<std::shared_ptr<BaseMessage>> messages;
+            // Objects to add to every branch vector, only used when writing asynchronously
+            std::vector<std::pair<std::vector<Object*>*, std::vector<Object*>>> objects;
+        };
+
+        /**
+         * @brief Fill the trees with the objects of an event and release its messages
+         * @param event Data of the event to write
+         */
+        void write_event(EventData event);
+
+        /**
+         * @brief Write the events handed over by the event loop until all events are written
+         */
+        void writer_loop();
+
+        /**
+         * @brief Stop the writer thread after it has written all queued events
+         */
+        void stop_writer();
+
         Configuration config_;
         GeometryManager* geo_mgr_;
 
@@ -78,12 +109,31 @@ namespace allpix {
         // List of trees that are stored in data file
         std::map<std::string, std::unique_ptr<TTree>> trees_;
 
-        // List of messages to keep so they can be stored in the tree
-        std::vector<std::shared_ptr<BaseMessage>> keep_messages_;
+        // Objects received in the current event and the messages to keep because they contain the objects
+        EventData current_event_;
         // List of objects of a particular type, bound to a specific detector and having a particular name
         std::map<std::tuple<std::type_index, std::string, std::string>, std::vector<Object*>*> write_list_;
+        // Buffering of the trees
+        int basket_size_{};
+        Long64_t auto_flush_{};
+        Long64_t auto_save_{};
+
+        // Lock protecting the trees and their branches while they are filled by the writer thread
+        std::mutex write_mutex_;
+
+        // Thread writing the events in the background and the bounded queue of events to write
+        bool async_writing_{};
+        size_t async_queue_size_{};
+        std::thread writer_thread_;
+        std::mutex queue_mutex_;
+        std::condition_variable queue_condition_;
+        std::deque<EventData> queue_;
+        bool stop_writer_{};
+        std::exception_ptr writer_exception_;
 
-        // Statistical information about number of objects
+        // Statistical information about number of objects, the written events and the time spent writing them
         unsigned long write_cnt_{};
+        unsigned long write_events_{};
+        std::chrono::steady_clock::duration write_time_{};
     };
 } // namespace allpix
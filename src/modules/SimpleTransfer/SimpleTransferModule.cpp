@@ -9,6 +9,7 @@
 
 #include "SimpleTransferModule.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
 #include <memory>
@@ -34,25 +35,37 @@ SimpleTransferModule::SimpleTransferModule(Configuration config, Messenger* mess
 
     // Set default value for the maximum depth distance to transfer
     config_.setDefault("max_depth_distance", Units::get(5.0, "um"));
+    bind_parameter(config_, "max_depth_distance", max_depth_distance_);
 
     // Save detector model
     model_ = detector_->getModel();
 
+    // Allocate the slots of all pixels once, such that the charges can be collected without any lookup in every event
+    auto pixels = static_cast<size_t>(model_->getNPixels().x()) * static_cast<size_t>(model_->getNPixels().y());
+    pixel_slots_.assign(pixels, 0);
+    unique_pixels_.assign(pixels, false);
+
     // Require propagated deposits for single detector
     messenger->bindSingle(this, &SimpleTransferModule::propagated_message_, MsgFlags::REQUIRED);
 }
 
+/**
+ * The propagated charges are collected in a flat array over all pixels, which stores the slot of every pixel hit in the
+ * current event. Only the slots of the hit pixels are reset at the end of the event. The hit pixels are sorted by their
+ * linear index, such that the pixel charges are created in the same order as the pixel indices are sorted by their x and y
+ * coordinate.
+ */
 void SimpleTransferModule::run(unsigned int) {
     // Find corresponding pixels for all propagated charges
     LOG(TRACE) << "Transferring charges to pixels";
     unsigned int transferred_charges_count = 0;
-    std::map<Pixel::Index, std::vector<const PropagatedCharge*>, pixel_cmp> pixel_map;
+    auto ypixels = static_cast<size_t>(model_->getNPixels().y());
     for(auto& propagated_charge : propagated_message_->getData()) {
         auto position = propagated_charge.getLocalPosition();
         // Ignore if outside depth range of implant
         // FIXME This logic should be improved
         if(std::fabs(position.z() - (model_->getSensorCenter().z() + model_->getSensorSize().z() / 2.0)) >
-           config_.get<double>("max_depth_distance")) {
+           max_depth_distance_) {
             LOG(DEBUG) << "Skipping set of " << propagated_charge.getCharge() << " propagated charges at "
                        << propagated_charge.getLocalPosition() << " because their local position is not in implant range";
             continue;
@@ -69,46 +82,69 @@ void SimpleTransferModule::run(unsigned int) {
                        << ") is outside the grid";
             continue;
         }
-        Pixel::Index pixel_index(static_cast<unsigned int>(xpixel), static_cast<unsigned int>(ypixel));
+        auto pixel = static_cast<size_t>(xpixel) * ypixels + static_cast<size_t>(ypixel);
 
         // Update statistics
-        unique_pixels_.insert(pixel_index);
+        if(!unique_pixels_[pixel]) {
+            unique_pixels_[pixel] = true;
+            ++unique_pixels_count_;
+        }
         transferred_charges_count += propagated_charge.getCharge();
 
         LOG(DEBUG) << "Set of " << propagated_charge.getCharge() << " propagated charges at "
-                   << propagated_charge.getLocalPosition() << " brought to pixel " << pixel_index;
+                   << propagated_charge.getLocalPosition() << " brought to pixel "
+                   << Pixel::Index(static_cast<unsigned int>(xpixel), static_cast<unsigned int>(ypixel));
 
         // Add the pixel the list of hit pixels
-        pixel_map[pixel_index].emplace_back(&propagated_charge);
+        auto& slot = pixel_slots_[pixel];
+        if(slot == 0) {
+            hit_pixels_.push_back(pixel);
+            slot = static_cast<unsigned int>(hit_pixels_.size());
+            if(pixel_charges_.size() < hit_pixels_.size()) {
+                pixel_charges_.emplace_back();
+            }
+        }
+        pixel_charges_[slot - 1].emplace_back(&propagated_charge);
     }
 
     // Create pixel charges
     LOG(TRACE) << "Combining charges at same pixel";
-    std::vector<PixelCharge> pixel_charges;
-    for(auto& pixel_index_charge : pixel_map) {
+    std::sort(hit_pixels_.begin(), hit_pixels_.end());
+    auto pixel_charges = BufferPool::acquire<PixelCharge>();
+    pixel_charges.reserve(hit_pixels_.size());
+    for(auto pixel_index : hit_pixels_) {
+        auto& slot = pixel_slots_[pixel_index];
+        auto& propagated_charges = pixel_charges_[slot - 1];
+
         unsigned int charge = 0;
-        for(auto& propagated_charge : pixel_index_charge.second) {
+        for(auto& propagated_charge : propagated_charges) {
             charge += propagated_charge->getCharge();
         }
 
         // Get pixel object from detector
-        auto pixel = detector_->getPixel(pixel_index_charge.first.x(), pixel_index_charge.first.y());
+        auto pixel = detector_->getPixel(static_cast<unsigned int>(pixel_index / ypixels),
+                                         static_cast<unsigned int>(pixel_index % ypixels));
 
-        pixel_charges.emplace_back(pixel, charge, pixel_index_charge.second);
+        pixel_charges.emplace_back(pixel, charge, propagated_charges);
         LOG(DEBUG) << "Set of " << charge << " charges combined at " << pixel.getIndex();
+
+        // Release the pixel for the next event, keeping the memory of the list of charges
+        propagated_charges.clear();
+        slot = 0;
     }
 
     // Writing summary and update statistics
-    LOG(INFO) << "Transferred " << transferred_charges_count << " charges to " << pixel_map.size() << " pixels";
+    LOG(INFO) << "Transferred " << transferred_charges_count << " charges to " << hit_pixels_.size() << " pixels";
     total_transferred_charges_ += transferred_charges_count;
+    hit_pixels_.clear();
 
     // Dispatch message of pixel charges
-    auto pixel_message = std::make_shared<PixelChargeMessage>(pixel_charges, detector_);
+    auto pixel_message = std::make_shared<PixelChargeMessage>(std::move(pixel_charges), detector_);
     messenger_->dispatchMessage(this, pixel_message);
 }
 
 void SimpleTransferModule::finalize() {
     // Print statistics
-    LOG(INFO) << "Transferred total of " << total_transferred_charges_ << " charges to " << unique_pixels_.size()
+    LOG(INFO) << "Transferred total of " << total_transferred_charges_ << " charges to " << unique_pixels_count_
               << " different pixels";
 }
@@ -7,7 +7,6 @@
  * Intergovernmental Organization or submit itself to any jurisdiction.
  */
 
-#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -57,23 +56,21 @@ namespace allpix {
         std::shared_ptr<Detector> detector_;
         std::shared_ptr<DetectorModel> model_;
 
-        /**
-         * @brief Compare two pixels, necessary to store them in the a std::map
-         */
-        struct pixel_cmp {
-            bool operator()(const Pixel::Index& p1, const Pixel::Index& p2) const {
-                if(p1.x() == p2.x()) {
-                    return p1.y() < p2.y();
-                }
-                return p1.x() < p2.x();
-            }
-        };
+        // Maximum distance of the charges to the implant side to be transferred
+        double max_depth_distance_{};
 
         // Message containing the propagated charges
         std::shared_ptr<PropagatedChargeMessage> propagated_message_;
 
+        // Slot of every pixel in the list of pixels hit in the current event (or zero if the pixel is not hit yet)
+        std::vector<unsigned int> pixel_slots_;
+        // Linear index of the pixels hit in the current event and the propagated charges collected at each of them
+        std::vector<size_t> hit_pixels_;
+        std::vector<std::vector<const PropagatedCharge*>> pixel_charges_;
+
         // Statistical information
         unsigned int total_transferred_charges_{};
-        std::set<Pixel::Index, pixel_cmp> unique_pixels_;
+        std::vector<bool> unique_pixels_;
+        unsigned int unique_pixels_count_{};
     };
 } // namespace allpix
@@ -50,6 +50,9 @@ VisualizationGeant4Module::VisualizationGeant4Module(Configuration config, Messe
     // Set to accumulate all hits and display at the end by default
     config_.setDefault("accumulate", true);
     config_.setDefault("simple_view", true);
+    config_.setDefault("accumulate_time_step", Units::get(100ul, "ms"));
+    bind_parameter(config_, "accumulate", accumulate_);
+    bind_parameter(config_, "accumulate_time_step", accumulate_time_step_);
 
     // Check mode
     std::string mode = config_.get<std::string>("mode");
@@ -402,10 +405,9 @@ void VisualizationGeant4Module::set_visualization_attributes() {
 }
 
 void VisualizationGeant4Module::run(unsigned int) {
-    if(!config_.get<bool>("accumulate")) {
+    if(!accumulate_) {
         vis_manager_g4_->GetCurrentViewer()->ShowView();
-        std::this_thread::sleep_for(
-            std::chrono::nanoseconds(config_.get<unsigned long>("accumulate_time_step", Units::get(100ul, "ms"))));
+        std::this_thread::sleep_for(std::chrono::nanoseconds(accumulate_time_step_));
     }
 }
 
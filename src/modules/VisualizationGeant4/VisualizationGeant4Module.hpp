@@ -62,6 +62,10 @@ namespace allpix {
         Configuration config_;
         GeometryManager* geo_manager_;
 
+        // Parameters for displaying the events one by one
+        bool accumulate_{};
+        unsigned long accumulate_time_step_{};
+
         /**
          * @brief Set the visualization settings from the configuration
          */
@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief Utility to group pixels into clusters of adjacent pixels
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_CLUSTERING_H
+#define ALLPIX_CLUSTERING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace allpix {
+
+    /**
+     * @brief Finder of clusters of 8-connected pixels, pixels sharing a side or a corner belong to the same cluster
+     *
+     * The pixels are stored in a hash map of their indices, such that every pixel only has to look up its neighbours instead
+     * of comparing to all other pixels. Adjacent pixels are joined in a disjoint-set forest, which makes the clustering
+     * linear in the number of pixels. The finder keeps its memory between calls, such that it can be reused for every event.
+     */
+    class PixelClusterFinder {
+    public:
+        /**
+         * @brief Group pixels into clusters
+         * @param pixels List of pixels as a pair of their x and y index
+         * @return Number of clusters found
+         *
+         * Clusters are numbered in the order of their first pixel in the list. Pixels with the same index are part of the
+         * same cluster.
+         */
+        template <typename Index> size_t find(const std::vector<std::pair<Index, Index>>& pixels) {
+            parents_.resize(pixels.size());
+            sizes_.assign(pixels.size(), 1);
+            pixel_map_.clear();
+
+            for(size_t i = 0; i < pixels.size(); ++i) {
+                parents_[i] = i;
+
+                // Join the pixel with the neighbours added before, later neighbours join this pixel when they are added
+                auto x = static_cast<int64_t>(pixels[i].first);
+                auto y = static_cast<int64_t>(pixels[i].second);
+                auto existing = pixel_map_.emplace(key(x, y), i);
+                if(!existing.second) {
+                    join(existing.first->second, i);
+                    continue;
+                }
+                for(int64_t dx = -1; dx <= 1; ++dx) {
+                    for(int64_t dy = -1; dy <= 1; ++dy) {
+                        auto neighbour = pixel_map_.find(key(x + dx, y + dy));
+                        if(neighbour != pixel_map_.end() && neighbour->second != i) {
+                            join(neighbour->second, i);
+                        }
+                    }
+                }
+            }
+
+            // Number the clusters in the order of their first pixel
+            labels_.assign(pixels.size(), 0);
+            size_t clusters = 0;
+            for(size_t i = 0; i < pixels.size(); ++i) {
+                auto root = find_root(i);
+                if(labels_[root] == 0) {
+                    labels_[root] = ++clusters;
+                }
+                labels_[i] = labels_[root];
+            }
+            for(auto& label : labels_) {
+                --label;
+            }
+            return clusters;
+        }
+
+        /**
+         * @brief Get the cluster of every pixel from the last call to \ref PixelClusterFinder::find
+         * @return Number of the cluster (starting at zero) for every pixel in the order of the input
+         */
+        const std::vector<size_t>& getLabels() const { return labels_; }
+
+    private:
+        /**
+         * @brief Combine the x and y index of a pixel into a single key
+         */
+        static uint64_t key(int64_t x, int64_t y) {
+            return (static_cast<uint64_t>(x) << 32) ^ (static_cast<uint64_t>(y) & 0xFFFFFFFF);
+        }
+
+        /**
+         * @brief Find the root of the tree of a pixel, halving the path to the root on the way
+         */
+        size_t find_root(size_t pixel) {
+            while(parents_[pixel] != pixel) {
+                parents_[pixel] = parents_[parents_[pixel]];
+                pixel = parents_[pixel];
+            }
+            return pixel;
+        }
+
+        /**
+         * @brief Join the trees of two pixels, attaching the smaller tree to the larger one
+         */
+        void join(size_t first, size_t second) {
+            first = find_root(first);
+            second = find_root(second);
+            if(first == second) {
+                return;
+            }
+            if(sizes_[first] < sizes_[second]) {
+                std::swap(first, second);
+            }
+            parents_[second] = first;
+            sizes_[first] += sizes_[second];
+        }
+
+        std::unordered_map<uint64_t, size_t> pixel_map_;
+        std::vector<size_t> parents_;
+        std::vector<size_t> sizes_;
+        std::vector<size_t> labels_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_CLUSTERING_H */
@@ -0,0 +1,192 @@
+/**
+ * @file
+ * @brief Utilities to compute the mobility of charge carriers in silicon
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_MOBILITY_H
+#define ALLPIX_MOBILITY_H
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "core/utils/unit.h"
+
+namespace allpix {
+
+    /**
+     * @brief Parameterization of the charge carrier mobility in silicon by Jacoboni and Canali
+     *
+     * Parameterization variables from https://doi.org/10.1016/0038-1101(77)90054-5 (section 5.2)
+     */
+    class JacoboniCanaliMobility {
+    public:
+        /**
+         * @brief Default constructor for an empty parameterization
+         */
+        JacoboniCanaliMobility() = default;
+
+        /**
+         * @brief Construct the parameterization from its parameters
+         * @param saturation_velocity Saturation velocity of the charge carriers
+         * @param critical_field Critical electric field of the charge carriers
+         * @param beta Exponent of the parameterization
+         */
+        JacoboniCanaliMobility(double saturation_velocity, double critical_field, double beta)
+            : zero_field_mobility_(saturation_velocity / critical_field), critical_field_(critical_field), beta_(beta) {}
+
+        /**
+         * @brief Construct the parameterization for electrons
+         * @param temperature Temperature of the sensor
+         * @return Mobility parameterization for electrons at the given temperature
+         */
+        static JacoboniCanaliMobility electron(double temperature) {
+            return {Units::get(1.53e9 * std::pow(temperature, -0.87), "cm/s"),
+                    Units::get(1.01 * std::pow(temperature, 1.55), "V/cm"),
+                    2.57e-2 * std::pow(temperature, 0.66)};
+        }
+        /**
+         * @brief Construct the parameterization for holes
+         * @param temperature Temperature of the sensor
+         * @return Mobility parameterization for holes at the given temperature
+         */
+        static JacoboniCanaliMobility hole(double temperature) {
+            return {Units::get(1.62e8 * std::pow(temperature, -0.52), "cm/s"),
+                    Units::get(1.24 * std::pow(temperature, 1.68), "V/cm"),
+                    0.46 * std::pow(temperature, 0.17)};
+        }
+
+        /**
+         * @brief Compute the mobility
+         * @param efield_mag Magnitude of the electric field
+         * @return Mobility of the charge carriers
+         */
+        double operator()(double efield_mag) const {
+            return zero_field_mobility_ / std::pow(1. + std::pow(efield_mag / critical_field_, beta_), 1.0 / beta_);
+        }
+
+        /**
+         * @brief Get the mobility without electric field
+         * @return Mobility at zero electric field
+         */
+        double getZeroFieldMobility() const { return zero_field_mobility_; }
+        /**
+         * @brief Get the critical electric field
+         * @return Critical electric field
+         */
+        double getCriticalField() const { return critical_field_; }
+
+    private:
+        double zero_field_mobility_{};
+        double critical_field_{};
+        double beta_{};
+    };
+
+    /**
+     * @brief Lookup table to compute the Jacoboni-Canali mobility by linear interpolation
+     *
+     * The table is binned uniformly in \f$u = E / (E + E_c)\f$, which maps the full range of electric fields to the unit
+     * interval. Instead of the mobility itself, the table stores \f$\mu / (1 - u)\f$, which converges to the zero field
+     * mobility for both very small and very large fields and can therefore be interpolated accurately everywhere. The number
+     * of bins is doubled until the maximum relative deviation from the analytic formula, probed at multiple points in every
+     * bin, is below the requested accuracy. A margin is kept below the accuracy, because the largest deviation of a bin is
+     * generally located between the probed points.
+     */
+    class MobilityTable {
+    public:
+        /**
+         * @brief Default constructor for an empty table
+         */
+        MobilityTable() = default;
+
+        /**
+         * @brief Construct and validate the lookup table
+         * @param model Analytic mobility parameterization to tabulate
+         * @param accuracy Maximum relative deviation from the analytic formula (zero to always use the analytic formula)
+         * @param max_bins Maximum number of bins of the table
+         * @note If the accuracy cannot be reached with the maximum number of bins, the table with the maximum size is used
+         */
+        MobilityTable(JacoboniCanaliMobility model, double accuracy, size_t max_bins = (1 << 20))
+            : model_(std::move(model)) {
+            if(accuracy <= 0) {
+                return;
+            }
+
+            for(size_t bins = 64; bins <= max_bins; bins *= 2) {
+                // Fill the table, the last point is the limit of an infinite field
+                table_.resize(bins + 1);
+                scale_ = static_cast<double>(bins);
+                for(size_t i = 0; i < bins; ++i) {
+                    auto u = static_cast<double>(i) / scale_;
+                    table_[i] = model_(model_.getCriticalField() * u / (1 - u)) / (1 - u);
+                }
+                table_[bins] = model_.getZeroFieldMobility();
+
+                // Validate the table against the analytic formula at the centers of equal parts of every bin
+                deviation_ = 0;
+                for(size_t i = 0; i < bins; ++i) {
+                    for(size_t j = 0; j < probes_per_bin; ++j) {
+                        auto offset = (static_cast<double>(j) + 0.5) / static_cast<double>(probes_per_bin);
+                        auto u = (static_cast<double>(i) + offset) / scale_;
+                        auto efield_mag = model_.getCriticalField() * u / (1 - u);
+                        auto exact = model_(efield_mag);
+                        deviation_ = std::max(deviation_, std::fabs((*this)(efield_mag) - exact) / exact);
+                    }
+                }
+                if(deviation_ <= accuracy_margin * accuracy) {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @brief Compute the mobility
+         * @param efield_mag Magnitude of the electric field
+         * @return Mobility of the charge carriers
+         */
+        double operator()(double efield_mag) const {
+            if(table_.empty()) {
+                return model_(efield_mag);
+            }
+
+            auto u = efield_mag / (efield_mag + model_.getCriticalField());
+            auto position = u * scale_;
+            auto index = std::min(static_cast<size_t>(position), table_.size() - 2);
+            auto fraction = position - static_cast<double>(index);
+            return (1 - u) * (table_[index] + fraction * (table_[index + 1] - table_[index]));
+        }
+
+        /**
+         * @brief Get the number of bins of the table
+         * @return Number of bins (zero if the analytic formula is used)
+         */
+        size_t getBins() const { return (table_.empty() ? 0 : table_.size() - 1); }
+        /**
+         * @brief Get the maximum relative deviation from the analytic formula found during validation
+         * @return Maximum relative deviation at the probed points
+         */
+        double getDeviation() const { return deviation_; }
+        /**
+         * @brief Get the tabulated parameterization
+         * @return Analytic mobility parameterization
+         */
+        const JacoboniCanaliMobility& getModel() const { return model_; }
+
+    private:
+        // Number of points probed in every bin and fraction of the accuracy the probed deviation should stay below
+        static constexpr size_t probes_per_bin = 8;
+        static constexpr double accuracy_margin = 0.9;
+
+        JacoboniCanaliMobility model_;
+        std::vector<double> table_;
+        double scale_{};
+        double deviation_{};
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_MOBILITY_H */
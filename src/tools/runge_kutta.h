@@ -161,6 +161,164 @@ namespace allpix {
         T t_;
     };
 
+    /**
+     * @brief Class to perform arbitrary Runge-Kutta integration for a batch of independent equations at once
+     *
+     * Integrates K independent equations of dimension D in parallel. The values are stored as a structure of arrays, where
+     * every dimension is a contiguous column of K lanes, such that the arithmetic of the integration can be vectorized by
+     * the compiler. Every lane has its own time step and time, and lanes can be deactivated through a mask after their
+     * integration finished. Inactive lanes are passed to the step function, but their value, time and error are not
+     * updated.
+     */
+    template <typename T, int S, int K, typename StepFunction, int D = 3> class BatchedRungeKutta {
+    public:
+        /**
+         * @brief Values of all lanes, with the dimensions stored in separate columns
+         */
+        using Values = Eigen::Array<T, K, D>;
+        /**
+         * @brief Single scalar for every lane
+         */
+        using Lanes = Eigen::Array<T, K, 1>;
+        /**
+         * @brief Mask of active lanes
+         */
+        using Mask = Eigen::Array<bool, K, 1>;
+
+        /**
+         * @brief Utility type to return both the value and the error of all lanes at every step
+         */
+        class Step {
+        public:
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+            Values value;
+            Values error;
+        };
+
+        /**
+         * @brief Construct a batched Runge-Kutta integrator
+         * @param tableau One of the possible Runge-Kutta tables (see \ref allpix::tableau should be preferred)
+         * @param function Step function to integrate a step of all lanes, called with the time, the values and the mask of
+         *                 active lanes
+         * @param step_size Time step of the integration for all lanes
+         * @param initial_y Start values of the lanes to perform integration on
+         * @param initial_t Initial time at the start of the integration
+         */
+        BatchedRungeKutta(Eigen::Matrix<T, S + 2, S> tableau,
+                          StepFunction function,
+                          T step_size,
+                          Values initial_y,
+                          T initial_t = 0)
+            : tableau_(std::move(tableau)), function_(std::move(function)), y_(std::move(initial_y)) {
+            h_.setConstant(step_size);
+            t_.setConstant(initial_t);
+            error_.setZero();
+            active_.setConstant(true);
+        }
+
+        /**
+         * @brief Changes the time steps of all lanes
+         * @param step_size New time step of the integration for every lane
+         */
+        void setTimeStep(Lanes step_size) { h_ = std::move(step_size); }
+        /**
+         * @brief Return the time steps
+         * @return Current time step of the integration for every lane
+         */
+        Lanes getTimeStep() { return h_; }
+
+        /**
+         * @brief Changes the current values during integration
+         * @note Can be used to add additional processes during the integration
+         */
+        void setValue(Values y) { y_ = std::move(y); }
+        /**
+         * @brief Get the values to integrate
+         * @return Current values of all lanes
+         */
+        Values getValue() { return y_; }
+        /**
+         * @brief Get the total integration error
+         * @return Total integrated error of all lanes
+         */
+        Values getError() { return error_; }
+        /**
+         * @brief Get the time during integration
+         * @return Current time of every lane
+         */
+        Lanes getTime() { return t_; }
+
+        /**
+         * @brief Changes the mask of active lanes
+         * @param active Mask with the lanes which should be integrated further
+         */
+        void setActive(Mask active) { active_ = std::move(active); }
+        /**
+         * @brief Get the mask of active lanes
+         * @return Mask with the lanes which are still integrated
+         */
+        Mask getActive() { return active_; }
+
+        /**
+         * @brief Execute a single time step of the integration for all active lanes
+         * @return Combination of the current value and the error in this single step (zero for inactive lanes)
+         */
+        Step step() {
+            // Initialize values
+            Step step;
+            Values ys;
+            Values yse;
+            ys.setZero();
+            yse.setZero();
+
+            // Compute step
+            Values k[static_cast<size_t>(S)];
+            for(int i = 0; i < S; ++i) {
+                Values yt = y_;
+                Lanes tt = t_;
+                for(int j = 0; j < i; ++j) {
+                    Lanes hk = h_ * tableau_(i, j);
+                    yt += hk.template replicate<1, D>() * k[j];
+                    tt += hk;
+                }
+                k[i] = function_(tt, yt, active_);
+
+                Lanes hs = h_ * tableau_(S, i);
+                Lanes hse = h_ * tableau_(S + 1, i);
+                ys += hs.template replicate<1, D>() * k[i];
+                yse += hse.template replicate<1, D>() * k[i];
+            }
+
+            // Update values of the active lanes with new step
+            auto active = active_.template replicate<1, D>();
+            step.value = active.select(ys, T(0));
+            step.error = active.select(ys - yse, T(0));
+            y_ += step.value;
+            t_ = active_.select(t_ + h_, t_);
+            error_ += step.error;
+
+            // Return step information
+            return step;
+        }
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        const Eigen::Matrix<T, S + 2, S> tableau_;
+        StepFunction function_;
+        // Step size of every lane
+        Lanes h_;
+
+        // Values to integrate
+        Values y_;
+        // Total error of every lane
+        Values error_;
+        // Current time of every lane
+        Lanes t_;
+        // Lanes still being integrated
+        Mask active_;
+    };
+
     // clang-format off
     namespace tableau {
         /**
@@ -209,6 +367,19 @@ namespace allpix {
     RungeKutta<T, S, D> make_runge_kutta(const Eigen::Matrix<T, S + 2, S>& tableau, Args&&... args) {
         return RungeKutta<T, S, D>(tableau, std::forward<Args>(args)...);
     }
+
+    /**
+     * @brief Utility function to create BatchedRungeKutta class using template deduction
+     * @param tableau One of the possible Runge-Kutta tableaus (see \ref allpix::tableau)
+     * @param function Step function to integrate a step of all lanes
+     * @param args Other forwarded arguments to the \ref BatchedRungeKutta::BatchedRungeKutta constructor
+     * @return Instantiation of \ref BatchedRungeKutta class with the forwarded arguments
+     */
+    template <int K, int D = 3, typename T, int S, typename StepFunction, class... Args>
+    BatchedRungeKutta<T, S, K, StepFunction, D>
+    make_batched_runge_kutta(const Eigen::Matrix<T, S + 2, S>& tableau, StepFunction function, Args&&... args) {
+        return BatchedRungeKutta<T, S, K, StepFunction, D>(tableau, std::move(function), std::forward<Args>(args)...);
+    }
 } // namespace allpix
 
 #endif /* ALLPIX_RUNGE_KUTTA_H */
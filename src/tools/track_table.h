@@ -0,0 +1,129 @@
+/**
+ * @file
+ * @brief Utility to collect the tracks of an event passing a sensor
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#ifndef ALLPIX_TRACK_TABLE_H
+#define ALLPIX_TRACK_TABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace allpix {
+
+    /**
+     * @brief Table of the tracks of an event, with their parent, particle type and first and last position
+     *
+     * The tracks are stored in a flat list, together with a dense list of slots indexed by the track id which holds the
+     * position of every track in the list. Geant4 numbers the tracks of an event consecutively starting from one, thus the
+     * slots stay small and every lookup is a single index operation. Only the slots in use are reset when the table is
+     * cleared, such that the table can be reused for every event without reallocating its memory.
+     */
+    template <typename Point> class TrackTable {
+    public:
+        /**
+         * @brief Information about a single track
+         */
+        struct Track {
+            int id;
+            int parent_id;
+            int pdg_code;
+            Point begin;
+            Point end;
+        };
+
+        /**
+         * @brief Find a track in the table
+         * @param track_id Identifier of the track (strictly positive)
+         * @return Pointer to the track or a null pointer if the track has not been added yet
+         */
+        Track* find(int track_id) {
+            auto slot = static_cast<size_t>(track_id);
+            if(slot >= slots_.size() || slots_[slot] == 0) {
+                return nullptr;
+            }
+            return &tracks_[slots_[slot] - 1];
+        }
+
+        /**
+         * @brief Add a track which is not part of the table yet
+         * @param track_id Identifier of the track (strictly positive)
+         * @param parent_id Identifier of the parent track (zero for primary tracks)
+         * @param pdg_code PDG code of the particle of the track
+         * @param begin First position of the track, which is also used as its last position until it is updated
+         * @return Reference to the added track
+         */
+        Track& insert(int track_id, int parent_id, int pdg_code, const Point& begin) {
+            auto slot = static_cast<size_t>(track_id);
+            if(slot >= slots_.size()) {
+                slots_.resize(std::max(slot + 1, 2 * slots_.size()), 0);
+            }
+            tracks_.push_back({track_id, parent_id, pdg_code, begin, begin});
+            slots_[slot] = tracks_.size();
+            return tracks_.back();
+        }
+
+        /**
+         * @brief Sort the tracks in the order of their identifier
+         * @return List of the sorted tracks
+         *
+         * After sorting, \ref TrackTable::getIndex and \ref TrackTable::getParentIndex return the position in this list.
+         */
+        const std::vector<Track>& sort() {
+            std::sort(tracks_.begin(), tracks_.end(), [](const Track& a, const Track& b) { return a.id < b.id; });
+            for(size_t i = 0; i < tracks_.size(); ++i) {
+                slots_[static_cast<size_t>(tracks_[i].id)] = i + 1;
+            }
+            return tracks_;
+        }
+
+        /**
+         * @brief Get the position of a track in the list of tracks
+         * @param track_id Identifier of a track in the table
+         * @return Index of the track
+         */
+        size_t getIndex(int track_id) const { return slots_[static_cast<size_t>(track_id)] - 1; }
+
+        /**
+         * @brief Get the position of the parent of a track in the list of tracks
+         * @param track Track in the table
+         * @return Index of the parent track or the maximum index if the parent is not part of the table
+         */
+        size_t getParentIndex(const Track& track) const {
+            auto slot = static_cast<size_t>(track.parent_id);
+            if(track.parent_id <= 0 || slot >= slots_.size() || slots_[slot] == 0) {
+                return std::numeric_limits<size_t>::max();
+            }
+            return slots_[slot] - 1;
+        }
+
+        /**
+         * @brief Get the number of tracks in the table
+         * @return Number of tracks
+         */
+        size_t size() const { return tracks_.size(); }
+
+        /**
+         * @brief Remove all tracks, keeping the memory of the table
+         */
+        void clear() {
+            for(auto& track : tracks_) {
+                slots_[static_cast<size_t>(track.id)] = 0;
+            }
+            tracks_.clear();
+        }
+
+    private:
+        std::vector<Track> tracks_;
+        // Position of every track id in the list of tracks plus one (or zero if the track is not part of the table)
+        std::vector<size_t> slots_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_TRACK_TABLE_H */
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief Validation of the tabulated carrier mobility against the analytic parameterization
+ *
+ * The tables are evaluated at electric fields which are independent of the points probed while building them: randomly
+ * drawn fields, fields on and around the bin edges and fields far above the critical field. The tables are built for both
+ * carrier types at two temperatures, as done by the GenericPropagation module, and are additionally evaluated on linear
+ * field profiles as done by the ProjectionPropagation module. The test fails if the relative deviation from the analytic
+ * parameterization exceeds the requested accuracy anywhere.
+ *
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/utils/unit.h"
+#include "tools/mobility.h"
+
+using namespace allpix;
+
+/**
+ * @brief Maximum relative deviation of the table from the parameterization at the given fields
+ */
+static double max_deviation(const MobilityTable& table, const std::vector<double>& fields) {
+    double deviation = 0;
+    for(auto efield_mag : fields) {
+        auto exact = table.getModel()(efield_mag);
+        deviation = std::max(deviation, std::fabs(table(efield_mag) - exact) / exact);
+    }
+    return deviation;
+}
+
+/**
+ * @brief Maximum relative deviation of the mobility averaged between two points of linear field profiles
+ *
+ * The ProjectionPropagation module computes the diffusion from the average mobility at the position of the deposit and at
+ * the top of the sensor, both in a linear electric field.
+ */
+static double max_profile_deviation(const MobilityTable& table, std::mt19937_64& random_generator) {
+    const auto& model = table.getModel();
+    std::uniform_real_distribution<double> depth(0, 1);
+    std::uniform_real_distribution<double> log_field(-2, 3);
+
+    double deviation = 0;
+    for(size_t i = 0; i < 100000; ++i) {
+        auto efield_top = model.getCriticalField() * std::pow(10, log_field(random_generator));
+        auto efield_mag = efield_top * depth(random_generator);
+        auto exact = (model(efield_mag) + model(efield_top)) / 2.;
+        deviation = std::max(deviation, std::fabs((table(efield_mag) + table(efield_top)) / 2. - exact) / exact);
+    }
+    return deviation;
+}
+
+int main() {
+    // Register the units used by the parameterization
+    Units::add("mm", 1);
+    Units::add("cm", 1e1);
+    Units::add("ns", 1);
+    Units::add("s", 1e9);
+    Units::add("V", 1e-6);
+
+    const double accuracy = 1e-4;
+    std::mt19937_64 random_generator(123456789);
+
+    bool success = true;
+    for(auto temperature : {233.15, 293.15}) {
+        for(auto electron : {true, false}) {
+            auto model =
+                (electron ? JacoboniCanaliMobility::electron(temperature) : JacoboniCanaliMobility::hole(temperature));
+            MobilityTable table(model, accuracy);
+            auto critical_field = model.getCriticalField();
+            auto bins = table.getBins();
+
+            // Randomly drawn fields, uniformly in the binning variable and logarithmically in the field
+            std::vector<double> random_fields;
+            std::uniform_real_distribution<double> uniform(0, 1);
+            std::uniform_real_distribution<double> log_field(-6, 6);
+            for(size_t i = 0; i < 1000000; ++i) {
+                auto u = uniform(random_generator);
+                random_fields.push_back(critical_field * u / (1 - u));
+                random_fields.push_back(critical_field * std::pow(10, log_field(random_generator)));
+            }
+
+            // Fields exactly on and just around the bin edges
+            std::vector<double> edge_fields;
+            for(size_t i = 0; i < bins; ++i) {
+                auto u = static_cast<double>(i) / static_cast<double>(bins);
+                auto efield_mag = critical_field * u / (1 - u);
+                edge_fields.push_back(efield_mag);
+                edge_fields.push_back(std::nextafter(efield_mag, 0.));
+                edge_fields.push_back(std::nextafter(efield_mag, std::numeric_limits<double>::max()));
+                edge_fields.push_back(efield_mag * (1 - 1e-9));
+                edge_fields.push_back(efield_mag * (1 + 1e-9));
+            }
+
+            // Fields far above the critical field, in the last bin of the table
+            std::vector<double> high_fields;
+            for(auto scale : {1e3, 1e4, 1e5, 1e6}) {
+                high_fields.push_back(critical_field * scale);
+            }
+
+            auto random_deviation = max_deviation(table, random_fields);
+            auto edge_deviation = max_deviation(table, edge_fields);
+            auto high_deviation = max_deviation(table, high_fields);
+            auto profile_deviation = max_profile_deviation(table, random_generator);
+            auto deviation = std::max({random_deviation, edge_deviation, high_deviation, profile_deviation});
+
+            std::cout << (electron ? "Electron" : "Hole") << " mobility at " << temperature << "K in " << bins
+                      << " bins: maximum deviation " << random_deviation << " (random fields), " << edge_deviation
+                      << " (bin edges), " << high_deviation << " (high fields), " << profile_deviation
+                      << " (linear field profiles)" << std::endl;
+            if(!(deviation <= accuracy)) {
+                std::cout << "Deviation exceeds the requested accuracy of " << accuracy << std::endl;
+                success = false;
+            }
+        }
+    }
+
+    return (success ? 0 : 1);
+}
@@ -0,0 +1,244 @@
+/**
+ * @file
+ * @brief Benchmark of the track table of the sensitive detector against the earlier implementation with maps
+ *
+ * Synthetic events are generated as sequences of steps, each with the id and parent id of its track and its position,
+ * following the order in which Geant4 processes tracks: primary tracks crossing the sensor in many short steps create
+ * secondary tracks, which are processed after their parent from a stack. Secondary tracks not reaching the sensor leave gaps
+ * in the track ids. Both implementations collect the tracks of every event, create the particles, link them to their parents
+ * and link every deposit to its particle. The test fails if the results differ and reports the time spent per event.
+ *
+ * @copyright Copyright (c) 2017 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "tools/track_table.h"
+
+using namespace allpix;
+
+/**
+ * @brief Position of a step
+ */
+struct Point {
+    double x, y, z;
+};
+
+/**
+ * @brief Single step of a track in the sensor
+ */
+struct Step {
+    int track_id;
+    int parent_id;
+    int pdg_code;
+    Point begin;
+    Point end;
+};
+
+/**
+ * @brief Particles and links created at the end of an event
+ */
+struct Result {
+    std::vector<int> particle_ids;
+    std::vector<int> particle_pdg_codes;
+    std::vector<double> particle_lengths;
+    std::vector<size_t> particle_parents;
+    std::vector<size_t> deposit_particles;
+
+    bool operator==(const Result& other) const {
+        return particle_ids == other.particle_ids && particle_pdg_codes == other.particle_pdg_codes &&
+               particle_lengths == other.particle_lengths && particle_parents == other.particle_parents &&
+               deposit_particles == other.deposit_particles;
+    }
+};
+
+/**
+ * @brief Generate the steps of a synthetic event
+ */
+static std::vector<Step> generate_event(std::mt19937_64& random_generator) {
+    const int primaries = 1000;
+    const int primary_steps = 300;
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_int_distribution<int> secondary_steps(1, 20);
+
+    struct PendingTrack {
+        int id;
+        int parent_id;
+        int steps;
+        Point position;
+    };
+    std::vector<PendingTrack> stack;
+    for(int id = primaries; id > 0; --id) {
+        stack.push_back({id, 0, primary_steps, {uniform(random_generator), uniform(random_generator), 0}});
+    }
+
+    std::vector<Step> steps;
+    int next_id = primaries + 1;
+    while(!stack.empty()) {
+        auto track = stack.back();
+        stack.pop_back();
+
+        auto position = track.position;
+        for(int i = 0; i < track.steps; ++i) {
+            auto next = Point{position.x, position.y, position.z + 1e-3};
+            steps.push_back({track.id, track.parent_id, (track.parent_id == 0 ? 211 : 11), position, next});
+            position = next;
+
+            // Create secondary tracks, some of them never reaching the sensor
+            if(uniform(random_generator) < 0.02) {
+                auto steps_in_sensor = (uniform(random_generator) < 0.3 ? 0 : secondary_steps(random_generator));
+                stack.push_back({next_id++, track.id, steps_in_sensor, position});
+            }
+        }
+    }
+    return steps;
+}
+
+/**
+ * @brief Collect the tracks in maps keyed by the track id, as done before the track table
+ */
+class MapTracks {
+public:
+    void process(const Step& step) {
+        if(track_begin_.find(step.track_id) == track_begin_.end()) {
+            track_begin_.emplace(step.track_id, step.begin);
+            track_parents_.emplace(step.track_id, step.parent_id);
+            track_pdg_.emplace(step.track_id, step.pdg_code);
+        }
+        track_end_[step.track_id] = step.end;
+
+        // Every step deposits an electron and a hole
+        deposit_to_id_.push_back(step.track_id);
+        deposit_to_id_.push_back(step.track_id);
+    }
+
+    Result finish() {
+        Result result;
+        std::map<int, size_t> id_to_particle;
+        for(auto& track_id_point : track_begin_) {
+            auto track_id = track_id_point.first;
+            result.particle_ids.push_back(track_id);
+            result.particle_pdg_codes.push_back(track_pdg_.at(track_id));
+            result.particle_lengths.push_back(track_end_.at(track_id).z - track_id_point.second.z);
+            id_to_particle[track_id] = result.particle_ids.size() - 1;
+        }
+
+        result.particle_parents.resize(result.particle_ids.size(), std::numeric_limits<size_t>::max());
+        for(auto& track_parent : track_parents_) {
+            if(id_to_particle.find(track_parent.second) == id_to_particle.end()) {
+                continue;
+            }
+            result.particle_parents.at(id_to_particle.at(track_parent.first)) = id_to_particle.at(track_parent.second);
+        }
+
+        for(auto track_id : deposit_to_id_) {
+            result.deposit_particles.push_back(id_to_particle.at(track_id));
+        }
+
+        track_begin_.clear();
+        track_end_.clear();
+        track_parents_.clear();
+        track_pdg_.clear();
+        deposit_to_id_.clear();
+        return result;
+    }
+
+private:
+    std::map<int, Point> track_begin_;
+    std::map<int, Point> track_end_;
+    std::map<int, int> track_parents_;
+    std::map<int, int> track_pdg_;
+    std::vector<int> deposit_to_id_;
+};
+
+/**
+ * @brief Collect the tracks in the track table, as done by the sensitive detector
+ */
+class TableTracks {
+public:
+    void process(const Step& step) {
+        auto track = tracks_.find(step.track_id);
+        if(track == nullptr) {
+            track = &tracks_.insert(step.track_id, step.parent_id, step.pdg_code, step.begin);
+        }
+        track->end = step.end;
+
+        // Every step deposits an electron and a hole
+        deposit_to_id_.push_back(step.track_id);
+        deposit_to_id_.push_back(step.track_id);
+    }
+
+    Result finish() {
+        Result result;
+        auto& tracks = tracks_.sort();
+        for(auto& track : tracks) {
+            result.particle_ids.push_back(track.id);
+            result.particle_pdg_codes.push_back(track.pdg_code);
+            result.particle_lengths.push_back(track.end.z - track.begin.z);
+            result.particle_parents.push_back(tracks_.getParentIndex(track));
+        }
+
+        for(auto track_id : deposit_to_id_) {
+            result.deposit_particles.push_back(tracks_.getIndex(track_id));
+        }
+
+        tracks_.clear();
+        deposit_to_id_.clear();
+        return result;
+    }
+
+private:
+    TrackTable<Point> tracks_;
+    std::vector<int> deposit_to_id_;
+};
+
+/**
+ * @brief Process all events and measure the time spent collecting the tracks
+ */
+template <typename Tracks>
+static std::vector<Result> run(const std::vector<std::vector<Step>>& events, double& time_per_event) {
+    Tracks tracks;
+    std::vector<Result> results;
+    auto start = std::chrono::steady_clock::now();
+    for(auto& event : events) {
+        for(auto& step : event) {
+            tracks.process(step);
+        }
+        results.push_back(tracks.finish());
+    }
+    std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+    time_per_event = duration.count() / static_cast<double>(events.size());
+    return results;
+}
+
+int main() {
+    std::mt19937_64 random_generator(123456789);
+    std::vector<std::vector<Step>> events;
+    size_t total_steps = 0;
+    for(size_t i = 0; i < 20; ++i) {
+        events.push_back(generate_event(random_generator));
+        total_steps += events.back().size();
+    }
+    std::cout << "Generated " << events.size() << " events with " << total_steps / events.size() << " steps on average"
+              << std::endl;
+
+    double map_time = 0, table_time = 0;
+    auto map_results = run<MapTracks>(events, map_time);
+    auto table_results = run<TableTracks>(events, table_time);
+
+    std::cout << "Time per event with maps: " << map_time << "us, with the track table: " << table_time
+              << "us (speedup of " << map_time / table_time << ")" << std::endl;
+    if(!(map_results == table_results)) {
+        std::cout << "Particles or links differ between the implementations" << std::endl;
+        return 1;
+    }
+    return 0;
+}
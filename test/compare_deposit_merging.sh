@@ -0,0 +1,36 @@
+#!/bin/bash
+# Compare the deposition with and without merging the deposits of consecutive steps, using the same random seed
+# Arguments: the allpix executable and the directory of the test configurations
+
+ALLPIX=$1
+TEST_DIRECTORY=$2
+
+$ALLPIX -c $TEST_DIRECTORY/check_deposition_unmerged.conf -l unmerged.log > /dev/null || exit 1
+$ALLPIX -c $TEST_DIRECTORY/check_deposition_merged.conf -l merged.log > /dev/null || exit 1
+
+# Extract the deposited charge per sensor and in total, and the charge linked to every MC particle
+summarize() {
+    grep -o -e "Deposited [0-9]* charges in sensor of detector .*" \
+            -e "Deposited total of .*" \
+            -e "MC particle [0-9]* (PDG code .*" $1
+}
+summarize unmerged.log > unmerged.txt
+summarize merged.log > merged.txt
+
+if [ ! -s unmerged.txt ] || ! grep -q "MC particle" unmerged.txt; then
+    echo "No deposited charges found"
+    exit 1
+fi
+if ! diff unmerged.txt merged.txt; then
+    echo "Deposited charges differ with merging"
+    exit 1
+fi
+
+# The merging should reduce the number of deposits
+UNMERGED_DEPOSITS=$(grep -c "Created deposit of" unmerged.log)
+MERGED_DEPOSITS=$(grep -c "Created deposit of" merged.log)
+echo "Created $MERGED_DEPOSITS merged deposits instead of $UNMERGED_DEPOSITS with the same charge"
+if [ $MERGED_DEPOSITS -ge $UNMERGED_DEPOSITS ]; then
+    echo "Deposits have not been merged"
+    exit 1
+fi